@@ -0,0 +1,2348 @@
+#pragma once
+
+/**
+ * BKSearch.hpp
+ * Purpose: The Bron–Kerbosch search engine behind CliqueEnumeration, as header-only templates.
+ *
+ * BKSearch<PivotPolicy, Receiver> fixes the pivot rule and the receiver type at compile time, so the
+ * recursion makes no virtual calls of its own.  When Receiver is a class declared final, its callbacks
+ * are bound statically too.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <BitStructures.hpp>
+#include <FixedIntegerSet.hpp>
+#include <Graph.hpp>
+#include <CsrGraph.hpp>
+#include <CliqueEnumeration.hpp>
+
+namespace kn
+{
+    // Uncomment to enable pretty printing
+    //#define ENABLE_PRETTY_PRINT
+
+    /**
+    * Computes a degeneracy ordering by repeatedly removing a vertex of least remaining degree
+    * (the bucket method of Matula and Beck, as arranged by Batagelj and Zaversnik).  Each vertex
+    * then has at most d neighbours that come later in the order, where d is the degeneracy.
+    * The rows may be any adjacency offering numVertices, degree(v) and forEachNeighbour(v, f).
+    */
+    template <typename Rows>
+    std::vector<std::size_t> degeneracyOrder(const Rows& rows)
+    {
+        std::size_t numVertices = rows.numVertices;
+        std::vector<std::size_t> degree(numVertices);
+        std::size_t maxDegree = 0;
+        for (std::size_t v = 0; v < numVertices; v++)
+        {
+            degree[v] = rows.degree(v);
+            maxDegree = std::max(maxDegree, degree[v]);
+        }
+
+        /// bin[d] is the position of the first vertex of degree d in vertices
+        std::vector<std::size_t> bin(maxDegree + 1, 0);
+        for (std::size_t v = 0; v < numVertices; v++)
+        {
+            bin[degree[v]]++;
+        }
+        std::size_t start = 0;
+        for (std::size_t d = 0; d <= maxDegree; d++)
+        {
+            std::size_t count = bin[d];
+            bin[d] = start;
+            start += count;
+        }
+
+        std::vector<std::size_t> vertices(numVertices);
+        std::vector<std::size_t> position(numVertices);
+        for (std::size_t v = 0; v < numVertices; v++)
+        {
+            position[v] = bin[degree[v]]++;
+            vertices[position[v]] = v;
+        }
+        for (std::size_t d = maxDegree; d > 0; d--)
+        {
+            bin[d] = bin[d - 1];
+        }
+        bin[0] = 0;
+
+        for (std::size_t i = 0; i < numVertices; i++)
+        {
+            std::size_t v = vertices[i];
+            rows.forEachNeighbour(v, [&](std::size_t u)
+            {
+                if (degree[u] > degree[v])
+                {
+                    /// Move u to the front of its bin, and then shrink the bin past it.
+                    std::size_t du = degree[u];
+                    std::size_t pu = position[u];
+                    std::size_t pw = bin[du];
+                    std::size_t w = vertices[pw];
+                    if (u != w)
+                    {
+                        vertices[pu] = w;
+                        position[w] = pu;
+                        vertices[pw] = u;
+                        position[u] = pw;
+                    }
+                    bin[du]++;
+                    degree[u]--;
+                }
+            });
+        }
+
+        return vertices;
+    }
+
+
+    /// The adjacency rows of a graph, which may be shared by many enumerators.
+    /// N[v] holds the neighbours of v; K[v] holds its conflicts, which are its non-neighbours and v itself.
+    /// The rows of the complement are had by swapping the two, and moving v itself across.
+    /// Each family of rows lies in one slab, so that neighbouring rows share pages and cache lines.
+
+    class Adjacency
+    {
+    public:
+        std::size_t numVertices;
+        IntegerSetPool N;
+        IntegerSetPool K;
+
+        Adjacency(const CsrGraph& graph, bool complement = false)
+        {
+            numVertices = graph.countVertices();
+            N.reshape(numVertices, numVertices);
+            K.reshape(numVertices, numVertices);
+            for (std::size_t ui = 0; ui < numVertices; ui++)
+            {
+                IntegerSet& neighbours = complement ? K[ui] : N[ui];
+                IntegerSet& conflicts = complement ? N[ui] : K[ui];
+                for (uint32_t vi : graph.exitingTargets(ui))
+                {
+                    if (ui != vi) neighbours.add(vi);
+                }
+
+                conflicts.copy(neighbours);
+                conflicts.invert();
+                if (complement)
+                {
+                    conflicts.remove(ui);
+                    neighbours.add(ui);
+                }
+            }
+        }
+
+        Adjacency(const Graph* graph, bool complement = false)
+            : Adjacency(CsrGraph(*graph), complement)
+        {
+        }
+
+        /// Constructs rows for numVertices vertices without any edges; see connect.
+        Adjacency(std::size_t numVertices)
+        {
+            this->numVertices = 0;
+            reshape(numVertices);
+        }
+
+        /// Discards all edges, and resizes the rows for numVertices vertices.
+        /// The slabs are reused without reallocation unless they must grow.
+        void reshape(std::size_t numVertices)
+        {
+            this->numVertices = numVertices;
+            N.reshape(numVertices, numVertices);
+            K.reshape(numVertices, numVertices);
+            for (std::size_t v = 0; v < numVertices; v++)
+            {
+                K[v].fill();
+            }
+        }
+
+        void connect(std::size_t u, std::size_t v)
+        {
+            N[u].add(v);
+            N[v].add(u);
+            K[u].remove(v);
+            K[v].remove(u);
+        }
+
+        void disconnect(std::size_t u, std::size_t v)
+        {
+            N[u].remove(v);
+            N[v].remove(u);
+            K[u].add(v);
+            K[v].add(u);
+        }
+
+        std::size_t degree(std::size_t v) const
+        {
+            return N[v].count();
+        }
+
+        template <typename F>
+        void forEachNeighbour(std::size_t v, F f) const
+        {
+            auto it = N[v].iterator();
+            while (it.hasNext())
+            {
+                f(it.next());
+            }
+        }
+    };
+
+
+    /// The neighbour lists of a graph, each sorted by vertex index, in compressed sparse row form.
+    /// Unlike Adjacency, this takes space in proportion to the number of edges.
+
+    class SparseAdjacency
+    {
+    public:
+        std::size_t numVertices;
+        std::vector<std::size_t> offsets;
+        std::vector<std::size_t> targets;
+
+        /// The lists of graph are sorted already, so loops and parallel arcs are dropped in one pass.
+        SparseAdjacency(const CsrGraph& graph)
+        {
+            numVertices = graph.countVertices();
+            offsets.reserve(numVertices + 1);
+            offsets.push_back(0);
+            targets.reserve(graph.countArcs());
+            for (std::size_t ui = 0; ui < numVertices; ui++)
+            {
+                std::size_t first = targets.size();
+                for (uint32_t vi : graph.exitingTargets(ui))
+                {
+                    if ((ui != vi) && ((targets.size() == first) || (targets.back() != vi))) targets.push_back(vi);
+                }
+                offsets.push_back(targets.size());
+            }
+        }
+
+        SparseAdjacency(const Graph* graph)
+            : SparseAdjacency(CsrGraph(*graph))
+        {
+        }
+
+        std::size_t degree(std::size_t v) const
+        {
+            return offsets[v + 1] - offsets[v];
+        }
+
+        template <typename F>
+        void forEachNeighbour(std::size_t v, F f) const
+        {
+            for (std::size_t t = offsets[v]; t < offsets[v + 1]; t++)
+            {
+                f(targets[t]);
+            }
+        }
+    };
+
+
+    /// The order in which the top-level branches of an ordered search are taken.
+
+    class BranchOrder
+    {
+    public:
+        std::vector<std::size_t> vertices; /// the vertex of each branch; empty for index order
+        std::vector<std::size_t> position; /// the inverse of vertices
+
+        template <typename Rows>
+        BranchOrder(const Rows& rows, BranchOrdering ordering)
+        {
+            if (ordering == BranchOrdering::Degeneracy)
+            {
+                vertices = degeneracyOrder(rows);
+                position.resize(vertices.size());
+                for (std::size_t k = 0; k < vertices.size(); k++)
+                {
+                    position[vertices[k]] = k;
+                }
+            }
+        }
+
+        std::size_t vertex(std::size_t k) const
+        {
+            return vertices.empty() ? k : vertices[k];
+        }
+
+        /// Whether neighbour u of the branch vertex v is a candidate (in P) rather than excluded (in X).
+        bool candidate(std::size_t v, std::size_t u) const
+        {
+            return vertices.empty() ? (u < v) : (position[u] > position[v]);
+        }
+    };
+
+
+    /// The common context for many clique enumerators in the BronKerbosch family.
+
+    template <typename Receiver>
+    class Context
+    {
+    private:
+        IntegerSetPool pool;
+        IntegerSet* next;
+
+        std::deque<DecodedIntegerSet> decoded;  /// a stack of decoded sets, kept like the pool; a deque, so none moves
+        std::size_t decodedDepth;
+
+        const std::vector<std::size_t>* labels;
+        IntegerSet* labelled;
+        const std::vector<std::size_t>* outside;
+
+        std::size_t batchLimit; /// zero unless the receiver takes cliques in batches
+        CliqueBatch batch;
+
+        void append(const IntegerSet& S)
+        {
+            std::size_t first = batch.vertices.size();
+            if (outside)
+            {
+                for (std::size_t v : *outside)
+                {
+                    batch.vertices.push_back((uint32_t)v);
+                }
+            }
+            auto it = S.iterator();
+            while (it.hasNext())
+            {
+                batch.vertices.push_back((uint32_t)label(it.next()));
+            }
+            if (labels)
+            {
+                std::sort(batch.vertices.begin() + first, batch.vertices.end());
+            }
+            batch.offsets.push_back(batch.vertices.size());
+
+            if (batch.count() >= batchLimit) flush();
+        }
+
+    public:
+        std::size_t numVertices;
+        const IntegerSetPool& N;
+        const IntegerSetPool& K;
+
+        const Graph* graph;
+        const Adjacency* adjacency;
+        Receiver* receiver;
+
+        typedef Receiver ReceiverType;
+
+        Context(const Graph* graph, const Adjacency& adjacency, Receiver* receiver) :
+            N(adjacency.N), K(adjacency.K)
+        {
+            this->graph = graph;
+            this->adjacency = &adjacency;
+            this->receiver = receiver;
+
+            this->labels = nullptr;
+            this->labelled = nullptr;
+            this->outside = nullptr;
+            this->batchLimit = receiver->batchSize();
+
+            reshape();
+        }
+
+        /// Sizes the pool to suit the adjacency, which may have been reshaped since the last call.
+        void reshape()
+        {
+            numVertices = adjacency->numVertices;
+
+            pool.reshape(4 * (1+numVertices) + 3, std::max<std::size_t>(numVertices, 1));
+            this->next = pool.data();
+            this->decodedDepth = 0;
+        }
+
+        /**
+        * Causes cliques to be reported in terms of other vertex labels: each member v is reported as
+        * labels[v], alongside the members listed in outside, which are already present in labelled.
+        * The members of outside may change between branches, but not their number.
+        */
+        void relabel(const std::vector<std::size_t>* labels, IntegerSet* labelled, const std::vector<std::size_t>* outside)
+        {
+            this->labels = labels;
+            this->labelled = labelled;
+            this->outside = outside;
+        }
+
+        std::size_t label(std::size_t v) const
+        {
+            return labels ? (*labels)[v] : v;
+        }
+
+        /// The number of members of every clique which lie outside this universe.
+        std::size_t outsideSize() const
+        {
+            return outside ? outside->size() : 0;
+        }
+
+        /// Describes the branch S, P, X in terms of the original vertex labels.
+        CliqueFrame frame(const IntegerSet& S, const IntegerSet& P, const IntegerSet& X) const
+        {
+            CliqueFrame f;
+            if (outside) f.S = *outside;
+            auto it = S.iterator();
+            while (it.hasNext()) f.S.push_back(label(it.next()));
+            auto it2 = P.iterator();
+            while (it2.hasNext()) f.P.push_back(label(it2.next()));
+            auto it3 = X.iterator();
+            while (it3.hasNext()) f.X.push_back(label(it3.next()));
+            return f;
+        }
+
+        void reportClique(const IntegerSet& S)
+        {
+            if (batchLimit)
+            {
+                append(S);
+            }
+            else
+            if (!labels)
+            {
+                receiver->onClique(*graph, S);
+            }
+            else
+            {
+                auto it = S.iterator();
+                while (it.hasNext())
+                {
+                    labelled->add((*labels)[it.next()]);
+                }
+                receiver->onClique(*graph, *labelled);
+                auto it2 = S.iterator();
+                while (it2.hasNext())
+                {
+                    labelled->remove((*labels)[it2.next()]);
+                }
+            }
+        }
+
+        /// Delivers any cliques still held in the batch.  Must precede the receiver's onComplete.
+        void flush()
+        {
+            if (batch.count() > 0)
+            {
+                receiver->onCliqueBatch(*graph, batch);
+                batch.clear();
+            }
+        }
+
+        IntegerSet* reserveSet()
+        {
+            return next++;
+        }
+
+        void releaseSet()
+        {
+            next--;
+        }
+
+        /// Decodes a into the next buffer of the stack, which holds it until the matching releaseDecoded.
+        const DecodedIntegerSet& reserveDecoded(const IntegerSet& a)
+        {
+            if (decodedDepth == decoded.size()) decoded.emplace_back();
+            return decoded[decodedDepth++].decode(a);
+        }
+
+        void releaseDecoded()
+        {
+            decodedDepth--;
+        }
+
+        IntegerSet* intersect(IntegerSet* a, const IntegerSet* b)
+        {
+            IntegerSet* r = reserveSet();
+            r->intersection(*a, *b);
+            return r;
+        }
+
+        IntegerSet* insert(IntegerSet* a, std::size_t value)
+        {
+            IntegerSet* r = reserveSet();
+            r->copy(*a);
+            r->add(value);
+            return r;
+        }
+    };
+
+
+    /// The limits on an enumeration, shared by all of its workers.
+    class BKBudget
+    {
+    private:
+        const CancellationToken* cancellation;
+        uint64_t recursionLimit;
+        bool timed;
+        std::chrono::steady_clock::time_point deadline;
+        std::atomic<uint64_t> recursions;
+        std::atomic<bool> stopped;
+
+    public:
+        /// A search consults the budget at the root of each branch it is given, and then once
+        /// per Interval recursive calls.
+        static constexpr uint64_t Interval = 1024;
+
+        BKBudget(const CliqueEnumerationOptions& options) :
+            cancellation(options.cancellation), recursionLimit(options.recursionLimit),
+            timed(options.timeLimit > 0.0), recursions(0), stopped(false)
+        {
+            if (timed)
+            {
+                deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(options.timeLimit));
+            }
+        }
+
+        static bool limits(const CliqueEnumerationOptions& options)
+        {
+            return (options.cancellation != nullptr) || (options.timeLimit > 0.0) || (options.recursionLimit > 0);
+        }
+
+        /// Accounts for further recursive calls, and decides whether the enumeration must stop.
+        bool exhausted(uint64_t calls)
+        {
+            if (stopped.load(std::memory_order_relaxed)) return true;
+
+            uint64_t total = (recursions += calls);
+            if ((cancellation && cancellation->isCancelled()) ||
+                (recursionLimit && (total >= recursionLimit)) ||
+                (timed && (std::chrono::steady_clock::now() >= deadline)))
+            {
+                stopped.store(true);
+                return true;
+            }
+            return false;
+        }
+
+        bool isStopped() const
+        {
+            return stopped.load(std::memory_order_relaxed);
+        }
+    };
+
+    inline void assignMembers(IntegerSet& set, const std::vector<std::size_t>& members)
+    {
+        set.clear();
+        for (std::size_t v : members)
+        {
+            set.add(v);
+        }
+    }
+
+    inline void listMembers(const IntegerSet& set, std::vector<std::size_t>& members)
+    {
+        auto it = set.iterator();
+        while (it.hasNext())
+        {
+            members.push_back(it.next());
+        }
+    }
+
+
+    /// A branch of the search tree, detached from the stack of the worker which found it.
+    struct BKTask
+    {
+        IntegerSet S;
+        IntegerSet P;
+        IntegerSet X;
+        std::size_t level; /// the depth of the branch below the root it was detached from
+
+        BKTask(const IntegerSet& S, const IntegerSet& P, const IntegerSet& X, std::size_t level) :
+            S(S), P(P), X(X), level(level) {}
+    };
+
+    /// The tasks owned by one worker.  The owner works at the back, while thieves steal from the front,
+    /// where the larger branches (those nearer the root) collect.
+    class TaskDeque
+    {
+    private:
+        std::mutex lock;
+        std::deque<std::unique_ptr<BKTask>> tasks;
+
+    public:
+        void push(std::unique_ptr<BKTask> task)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            tasks.push_back(std::move(task));
+        }
+
+        std::unique_ptr<BKTask> pop()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::unique_ptr<BKTask> task;
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+            }
+            return task;
+        }
+
+        std::unique_ptr<BKTask> steal()
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            std::unique_ptr<BKTask> task;
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            return task;
+        }
+
+        /// Describes the tasks which remain, as frames, and discards them.
+        void drain(std::vector<CliqueFrame>& frames)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (std::size_t t = 0; t < tasks.size(); t++)
+            {
+                CliqueFrame f;
+                listMembers(tasks[t]->S, f.S);
+                listMembers(tasks[t]->P, f.P);
+                listMembers(tasks[t]->X, f.X);
+                frames.push_back(std::move(f));
+            }
+            tasks.clear();
+        }
+    };
+
+    /**
+    * The work-stealing scheduler for parallel enumeration.  The roots of the search (the frames of a
+    * checkpoint being resumed, and then the top-level branches) are handed out in order from a shared
+    * counter.  A worker which finds nothing left to do announces itself as idle; busy workers respond
+    * by detaching sub-branches near their roots as tasks, which the idle worker then steals.
+    */
+    class BKScheduler
+    {
+    private:
+        std::vector<std::unique_ptr<TaskDeque>> deques;
+        std::size_t numBranches;
+        std::atomic<std::size_t> nextBranch;
+        std::atomic<std::size_t> pending; /// branches and tasks that are queued or running
+        std::atomic<std::size_t> idle;
+        const BKBudget* budget;
+
+    public:
+        static constexpr std::size_t NoBranch = ~(std::size_t)0;
+
+        BKScheduler(std::size_t numWorkers, std::size_t numBranches, const BKBudget* budget = nullptr) :
+            numBranches(numBranches), nextBranch(0), pending(0), idle(0), budget(budget)
+        {
+            for (std::size_t w = 0; w < numWorkers; w++)
+            {
+                deques.push_back(std::unique_ptr<TaskDeque>(new TaskDeque()));
+            }
+        }
+
+        bool hungry() const
+        {
+            return idle.load(std::memory_order_relaxed) > 0;
+        }
+
+        void spawn(std::size_t worker, const IntegerSet& S, const IntegerSet& P, const IntegerSet& X, std::size_t level)
+        {
+            pending++;
+            deques[worker]->push(std::unique_ptr<BKTask>(new BKTask(S, P, X, level)));
+        }
+
+        /// Obtains the next unit of work: either a task, or the index of a root.
+        /// Returns false once all work has been completed, or the budget has run out.
+        bool acquire(std::size_t worker, std::unique_ptr<BKTask>& task, std::size_t& branch)
+        {
+            bool waiting = false;
+            branch = NoBranch;
+            for (;;)
+            {
+                if (budget && budget->isStopped())
+                {
+                    if (waiting) idle--;
+                    return false;
+                }
+
+                task = deques[worker]->pop();
+
+                if (!task && (nextBranch.load() < numBranches))
+                {
+                    pending++;
+                    std::size_t k = nextBranch++;
+                    if (k < numBranches)
+                        branch = k;
+                    else
+                        pending--;
+                }
+
+                for (std::size_t t = 1; !task && (branch == NoBranch) && (t < deques.size()); t++)
+                {
+                    task = deques[(worker + t) % deques.size()]->steal();
+                }
+
+                if (task || (branch != NoBranch))
+                {
+                    if (waiting) idle--;
+                    return true;
+                }
+
+                if (pending.load() == 0)
+                {
+                    if (waiting) idle--;
+                    return false;
+                }
+
+                if (!waiting)
+                {
+                    idle++;
+                    waiting = true;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        void complete()
+        {
+            pending--;
+        }
+
+        /// Once the workers are done, records the roots and tasks which were never begun in rest.
+        void collect(const CliqueCheckpoint& plan, CliqueCheckpoint& rest)
+        {
+            std::size_t numFrames = plan.frames.size();
+            std::size_t begun = std::min(nextBranch.load(), numBranches);
+            for (std::size_t r = begun; r < numFrames; r++)
+            {
+                rest.frames.push_back(plan.frames[r]);
+            }
+            rest.nextBranch = plan.nextBranch + ((begun > numFrames) ? begun - numFrames : 0);
+
+            for (std::size_t w = 0; w < deques.size(); w++)
+            {
+                deques[w]->drain(rest.frames);
+            }
+        }
+    };
+
+
+    /**
+    * Instrumentation for BKSearch, chosen at compile time.  The search calls enter() on each recursive
+    * call, and its pivot rule calls scanned() and inPlace() as it works; report() hands the counts over.
+    * NoSearchStats does nothing, and so costs nothing once inlined.
+    */
+    struct NoSearchStats
+    {
+        template <typename Set>
+        void enter(std::size_t level, const Set& P, const Set& X) {}
+        void scanned(std::size_t words) {}
+        void inPlace() {}
+        void report(SearchStatistics* into) {}
+    };
+
+    /// Gathers SearchStatistics, at the cost of counting P and X on every call.
+    class SearchStatsCollector
+    {
+    private:
+        SearchStatistics statistics;
+        std::size_t current = 0;
+
+    public:
+        template <typename Set>
+        void enter(std::size_t level, const Set& P, const Set& X)
+        {
+            current = level;
+            SearchStatistics::Level& counts = statistics.at(level);
+            uint64_t p = P.count();
+            uint64_t x = X.count();
+            counts.calls++;
+            counts.sumCandidates += p;
+            counts.maxCandidates = std::max(counts.maxCandidates, p);
+            counts.sumExcluded += x;
+            counts.maxExcluded = std::max(counts.maxExcluded, x);
+        }
+
+        void scanned(std::size_t words)
+        {
+            statistics.levels[current].wordsScanned += words;
+        }
+
+        void inPlace()
+        {
+            statistics.levels[current].inPlace++;
+        }
+
+        /// Adds the counts so far to into (if given), and starts afresh.
+        void report(SearchStatistics* into)
+        {
+            if (into) into->accumulate(statistics);
+            statistics.clear();
+        }
+    };
+
+    /**
+    * A Bron–Kerbosch clique enumerator.  PivotPolicy provides a static pivotConflict(engine, S, P, X)
+    * which returns the vertices to branch on, as a set reserved from the search, or nullptr when
+    * there are none.  It may also move vertices into S in place.  Stats is NoSearchStats or
+    * SearchStatsCollector.
+    */
+    template <typename PivotPolicy, typename Receiver = CliqueReceiver, typename Stats = NoSearchStats>
+    class BKSearch : public Context<Receiver>
+    {
+    private:
+        typedef Context<Receiver> Base;
+
+        /// Sub-branches at most this far below the root of a task may be detached for idle workers.
+        static constexpr std::size_t SplitDepth = 2;
+
+        BKScheduler* scheduler;
+        std::size_t worker;
+        std::size_t depth;
+        std::size_t base; /// the depth of the current root in the whole search tree, less one
+
+        bool bounded;
+        std::size_t minSize;
+        std::size_t maxSize;
+        bool colourBound;
+
+        BKBudget* budget;
+        uint64_t sincePoll;
+        bool halted;
+        std::vector<CliqueFrame>* residue;
+
+        /// Decides whether the budget has run out, consulting it at each root and every so often.
+        bool interrupted()
+        {
+            if (!halted && ((++sincePoll >= BKBudget::Interval) || (depth == 1)))
+            {
+                halted = budget->exhausted(sincePoll);
+                sincePoll = 0;
+            }
+            return halted;
+        }
+
+        /// Records the unexplored branch S, P, X for a later run.
+        void keep(const IntegerSet* S, const IntegerSet* P, const IntegerSet* X)
+        {
+            if (residue) residue->push_back(this->frame(*S, *P, *X));
+        }
+
+        /// Greedily colours P, stopping once enough colours are used.  A clique within P has at most
+        /// one vertex of each colour, so the result bounds the clique number of P.
+        std::size_t countColours(const IntegerSet* P, std::size_t enough)
+        {
+            IntegerSet* U = reserveSet();
+            IntegerSet* C = reserveSet();
+
+            std::size_t k = 0;
+            U->copy(*P);
+            while ((k < enough) && !U->isEmpty())
+            {
+                k++;
+                C->copy(*U);
+                for (std::size_t v = C->firstElement(); v < numVertices; v = C->firstElement())
+                {
+                    U->remove(v);
+                    C->remove(v);
+                    C->removeAll(N[v]);
+                }
+            }
+
+            this->releaseSet(); // Release C
+            this->releaseSet(); // Release U
+            return k;
+        }
+
+        /// Decides whether no maximal clique of admissible size can be found below S, where P holds candidates vertices.
+        bool outOfBounds(const IntegerSet* S, const IntegerSet* P, std::size_t candidates)
+        {
+            std::size_t size = this->outsideSize() + S->count();
+            if (size >= maxSize)
+            {
+                return (size > maxSize) || (candidates > 0) || (size < minSize);
+            }
+            if (size >= minSize)
+            {
+                return false;
+            }
+
+            std::size_t needed = minSize - size;
+            if (candidates < needed) return true;
+            return colourBound && (countColours(P, needed) < needed);
+        }
+
+    public:
+        using Base::numVertices;
+        using Base::N;
+        using Base::K;
+        using Base::graph;
+        using Base::adjacency;
+        using Base::receiver;
+        using Base::label;
+        using Base::reportClique;
+        using Base::reserveSet;
+        using Base::flush;
+
+        Stats stats;
+
+        BKSearch(const Graph* graph, const Adjacency& adjacency, Receiver* receiver) :
+            Base(graph, adjacency, receiver), scheduler(nullptr), worker(0), depth(0), base(0),
+            bounded(false), minSize(0), maxSize(~(std::size_t)0), colourBound(false),
+            budget(nullptr), sincePoll(0), halted(false), residue(nullptr) {}
+
+        /// Restricts the search to maximal cliques of the sizes admitted by the options.
+        void bound(const CliqueEnumerationOptions& options)
+        {
+            minSize = options.minSize;
+            maxSize = options.maxSize;
+            colourBound = options.colourBound;
+            bounded = (minSize > 0) || (maxSize != ~(std::size_t)0);
+            if (minSize > maxSize)
+            {
+                /// no size is admitted, and so the search is cut off at its root
+                minSize = 1;
+                maxSize = 0;
+            }
+        }
+
+        /// Stops the search once budget runs out, recording the branches left unexplored in residue.
+        void limit(BKBudget* budget, std::vector<CliqueFrame>* residue)
+        {
+            this->budget = budget;
+            this->residue = residue;
+        }
+
+        /// Whether the budget ran out before the search was done.
+        bool stopped() const
+        {
+            return halted;
+        }
+
+        /**
+        * Prepares S, P and X for the k-th top-level branch of an ordered search, and returns its vertex.
+        * In index order, P holds the neighbours of vertex k which precede it, and X those which follow.
+        * Otherwise, P holds the neighbours which come later in the order, and X those which come earlier.
+        */
+        std::size_t branch(const BranchOrder& order, std::size_t k, IntegerSet* S, IntegerSet* P, IntegerSet* X)
+        {
+            S->clear();
+            P->clear();
+            X->clear();
+
+            if (order.vertices.empty())
+            {
+                S->add(k);
+                P->fillBefore(k);
+                X->fillAfter(k);
+                P->intersectWith(N[k]);
+                X->intersectWith(N[k]);
+                return k;
+            }
+            else
+            {
+                std::size_t v = order.vertex(k);
+                S->add(v);
+                auto it = N[v].iterator();
+                while (it.hasNext())
+                {
+                    std::size_t u = it.next();
+                    if (order.candidate(v, u))
+                        P->add(u);
+                    else
+                        X->add(u);
+                }
+                return v;
+            }
+        }
+
+        /// Runs this search as one worker of a parallel enumeration of plan, until the scheduler runs dry.
+        void work(const CliqueCheckpoint& plan, const BranchOrder& order, BKScheduler* scheduler, std::size_t worker)
+        {
+            this->scheduler = scheduler;
+            this->worker = worker;
+
+            std::unique_ptr<BKTask> task;
+            std::size_t r;
+            while (scheduler->acquire(worker, task, r))
+            {
+                IntegerSet* S = reserveSet();
+                IntegerSet* P = reserveSet();
+                IntegerSet* X = reserveSet();
+
+                base = 0;
+                if (task)
+                {
+                    S->copy(task->S);
+                    P->copy(task->P);
+                    X->copy(task->X);
+                    base = task->level;
+                    task.reset();
+                }
+                else
+                if (r < plan.frames.size())
+                {
+                    assignMembers(*S, plan.frames[r].S);
+                    assignMembers(*P, plan.frames[r].P);
+                    assignMembers(*X, plan.frames[r].X);
+                }
+                else
+                {
+                    branch(order, plan.nextBranch + (r - plan.frames.size()), S, P, X);
+                }
+
+                depth = 0;
+                apply(S, P, X);
+                // consumed by apply: S, P, X
+
+                scheduler->complete();
+            }
+
+            flush();
+            this->scheduler = nullptr;
+        }
+
+        /**
+        * Runs the frames of plan, and then its top-level branches from plan.nextBranch on, until they are
+        * done or the budget runs out.  The work left over is then recorded in rest, if given.
+        */
+        void enumerateCliques(const CliqueCheckpoint& plan, CliqueCheckpoint* rest)
+        {
+            receiver->reset();
+            receiver->onClear();
+            BranchOrder order(*adjacency, plan.ordering);
+            if (rest) residue = &rest->frames;
+
+            std::size_t f = 0;
+            for (; (f < plan.frames.size()) && !halted; f++)
+            {
+                IntegerSet* S = reserveSet();
+                IntegerSet* P = reserveSet();
+                IntegerSet* X = reserveSet();
+
+                assignMembers(*S, plan.frames[f].S);
+                assignMembers(*P, plan.frames[f].P);
+                assignMembers(*X, plan.frames[f].X);
+
+                depth = 0;
+                apply(S, P, X);
+                // consumed by apply: S, P, X
+            }
+
+            std::size_t n = numVertices;
+            std::size_t k = plan.nextBranch;
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+            bool grouped = (n > k + 1);
+            if (grouped) receiver->onOpenGroup();
+            bool first = true;
+            Graph::Vertex vertex;
+#endif
+
+            for (; (k < n) && !halted; k++)
+            {
+                IntegerSet* S = reserveSet();
+                IntegerSet* P = reserveSet();
+                IntegerSet* X = reserveSet();
+
+                std::size_t v = branch(order, k, S, P, X);
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                if (!first) receiver->onPartition();
+                first = false;
+                graph->getVertexByIndex(v, vertex);
+                receiver->onVertex(v, vertex.attrID);
+#else
+                (void)v;
+#endif
+
+                depth = 0;
+                apply(S, P, X);
+                // consumed by apply: S, P, X
+            }
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+            if (grouped && first) receiver->onCutOff();
+            if (grouped) receiver->onCloseGroup();
+#endif
+
+            if (rest)
+            {
+                rest->frames.insert(rest->frames.end(), plan.frames.begin() + f, plan.frames.end());
+                rest->nextBranch = k;
+            }
+            flush();
+            receiver->onComplete();
+        }
+
+        void apply(IntegerSet* S, IntegerSet* P, IntegerSet* X)
+        {
+            apply(S, P, X, bounded ? P->count() : !P->isEmpty(), !X->isEmpty());
+        }
+
+        /**
+        * As above, given what was learnt of P and X while they were computed: candidates is |P| when
+        * the search is bounded (and otherwise only whether P is non-empty), and excluded is whether X
+        * is non-empty.  When both are empty, S is a maximal clique, and no pivot is sought.
+        */
+        void apply(IntegerSet* S, IntegerSet* P, IntegerSet* X, std::size_t candidates, bool excluded)
+        {
+            receiver->recursionCounter++;
+            depth++;
+            stats.enter(base + depth - 1, *P, *X);
+            if (budget && interrupted())
+            {
+                /// cut-off: the budget has run out, so this branch is left for a later run
+                keep(S, P, X);
+                this->releaseSet(); // Release X
+                this->releaseSet(); // Release P
+                this->releaseSet(); // Release S
+                depth--;
+                return;
+            }
+
+            if (bounded && outOfBounds(S, P, candidates))
+            {
+                /// cut-off: every maximal clique here has the wrong size
+                receiver->sizePrunedCounter++;
+                this->releaseSet(); // Release X
+                this->releaseSet(); // Release P
+                this->releaseSet(); // Release S
+                depth--;
+                return;
+            }
+
+            bool leaf = (candidates == 0) && !excluded;
+            IntegerSet* Q = leaf ? nullptr : PivotPolicy::pivotConflict(*this, S, P, X);
+            if (Q)
+            {
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                bool grouped = (Q->countLimit(2) > 1);
+                if (grouped) receiver->onOpenGroup();
+                bool first = true;
+                Graph::Vertex vertex;
+#endif
+
+                const DecodedIntegerSet& conflicts = this->reserveDecoded(*Q);
+                for (std::size_t i = 0; i < conflicts.size(); i++)
+                {
+                    std::size_t v = conflicts[i];
+                    P->remove(v);
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                    if (!first) receiver->onPartition();
+                    first = false;
+                    graph->getVertexByIndex(label(v), vertex);
+                    receiver->onVertex(label(v), vertex.attrID);
+#endif
+
+                    IntegerSet* s2 = this->insert(S, v);
+                    IntegerSet* p2 = reserveSet();
+                    IntegerSet* x2 = reserveSet();
+                    std::size_t candidates2 = bounded ? p2->intersectionCount(*P, N[v]) : p2->intersectionAny(*P, N[v]);
+                    bool excluded2 = x2->intersectionAny(*X, N[v]);
+
+                    if (scheduler && (depth <= SplitDepth) && scheduler->hungry())
+                    {
+                        scheduler->spawn(worker, *s2, *p2, *x2, base + depth);
+                        this->releaseSet(); // Release x2
+                        this->releaseSet(); // Release p2
+                        this->releaseSet(); // Release s2
+                    }
+                    else
+                    {
+                        apply(s2, p2, x2, candidates2, excluded2);
+                    }
+
+                    X->add(v);
+
+                    if (halted)
+                    {
+                        /// The rest of this branch is left for a later run.
+                        if (i + 1 < conflicts.size()) keep(S, P, X);
+                        break;
+                    }
+                }
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                if (first) receiver->onCutOff();
+                if (grouped) receiver->onCloseGroup();
+#endif
+                this->releaseDecoded();
+                this->releaseSet(); // Release Q
+            }
+            else
+            if (bounded && !leaf && X->isEmpty() && outOfBounds(S, P, 0))
+            {
+                /// maximal clique found, but pivoting has taken it out of bounds (P is empty by now)
+                receiver->sizePrunedCounter++;
+            }
+            else
+            if (leaf || X->isEmpty())
+            {
+                /// maximal clique found
+                receiver->cliqueCounter++;
+                reportClique(*S);
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                receiver->onOk();
+#endif
+            }
+            else
+            {
+                /// cut-off: sub-maximal clique
+                receiver->cutOffCounter++;
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                receiver->onCutOff();
+#endif
+            }
+
+            this->releaseSet(); // Release X
+            this->releaseSet(); // Release P
+            this->releaseSet(); // Release S
+            depth--;
+        }
+    };
+
+
+    /**
+    * A Bron–Kerbosch clique enumerator for graphs of at most 64 * Words vertices, whose sets are
+    * FixedIntegerSets: no set owns heap memory, and no operation loops over a run-time word count.
+    * It takes the same pivot policies as BKSearch, and honours the size bounds, but has none of the
+    * parallel, budgeted or resumable modes.  MaximalCliques turns to it for small graphs whenever
+    * none of those is asked for, which suits enumerating over many small graphs in turn.
+    */
+    template <std::size_t Words, typename PivotPolicy, typename Receiver = CliqueReceiver, typename Stats = NoSearchStats>
+    class FixedBKSearch
+    {
+    public:
+        typedef FixedIntegerSet<Words> Set;
+
+    private:
+        std::vector<Set> pool;
+        Set* next;
+
+        std::deque<DecodedIntegerSet> decoded;
+        std::size_t decodedDepth;
+
+        IntegerSet clique;          /// S, as given to the receiver
+        std::size_t batchLimit;     /// zero unless the receiver takes cliques in batches
+        CliqueBatch batch;
+
+        std::size_t depth;
+        bool bounded;
+        std::size_t minSize;
+        std::size_t maxSize;
+        bool colourBound;
+
+        /// As BKSearch::countColours.
+        std::size_t countColours(const Set* P, std::size_t enough)
+        {
+            Set* U = reserveSet();
+            Set* C = reserveSet();
+
+            std::size_t k = 0;
+            U->copy(*P);
+            while ((k < enough) && !U->isEmpty())
+            {
+                k++;
+                C->copy(*U);
+                for (std::size_t v = C->firstElement(); v < numVertices; v = C->firstElement())
+                {
+                    U->remove(v);
+                    C->remove(v);
+                    C->removeAll(N[v]);
+                }
+            }
+
+            releaseSet(); // Release C
+            releaseSet(); // Release U
+            return k;
+        }
+
+        /// As BKSearch::outOfBounds.
+        bool outOfBounds(const Set* S, const Set* P, std::size_t candidates)
+        {
+            std::size_t size = S->count();
+            if (size >= maxSize)
+            {
+                return (size > maxSize) || (candidates > 0) || (size < minSize);
+            }
+            if (size >= minSize)
+            {
+                return false;
+            }
+
+            std::size_t needed = minSize - size;
+            if (candidates < needed) return true;
+            return colourBound && (countColours(P, needed) < needed);
+        }
+
+        void reportClique(const Set& S)
+        {
+            if (batchLimit)
+            {
+                auto it = S.iterator();
+                while (it.hasNext())
+                {
+                    batch.vertices.push_back((uint32_t)it.next());
+                }
+                batch.offsets.push_back(batch.vertices.size());
+
+                if (batch.count() >= batchLimit) flush();
+            }
+            else
+            {
+                S.copyTo(clique);
+                receiver->onClique(*graph, clique);
+            }
+        }
+
+    public:
+        std::size_t numVertices;
+        std::vector<Set> N;
+        std::vector<Set> K;
+
+        const Graph* graph;
+        Receiver* receiver;
+        Stats stats;
+
+        typedef Receiver ReceiverType;
+
+        /// Builds the rows of graph, or of its complement, which must have at most 64 * Words vertices.
+        FixedBKSearch(const CsrGraph& graph, bool complement, Receiver* receiver) :
+            decodedDepth(0), depth(0), bounded(false), minSize(0), maxSize(~(std::size_t)0), colourBound(false),
+            graph(&graph.getGraph()), receiver(receiver)
+        {
+            numVertices = graph.countVertices();
+            assert((numVertices > 0) && (numVertices <= Set::Capacity));
+
+            N.assign(numVertices, Set(numVertices));
+            K.assign(numVertices, Set(numVertices));
+            for (std::size_t ui = 0; ui < numVertices; ui++)
+            {
+                Set& neighbours = complement ? K[ui] : N[ui];
+                Set& conflicts = complement ? N[ui] : K[ui];
+                for (uint32_t vi : graph.exitingTargets(ui))
+                {
+                    if (ui != vi) neighbours.add(vi);
+                }
+
+                conflicts.copy(neighbours);
+                conflicts.invert();
+                if (complement)
+                {
+                    conflicts.remove(ui);
+                    neighbours.add(ui);
+                }
+            }
+
+            pool.assign(4 * (1+numVertices) + 3, Set(numVertices));
+            next = pool.data();
+            clique.setMaxCardinality(numVertices);
+            batchLimit = receiver->batchSize();
+        }
+
+        std::size_t label(std::size_t v) const
+        {
+            return v;
+        }
+
+        /// Restricts the search to maximal cliques of the sizes admitted by the options.
+        void bound(const CliqueEnumerationOptions& options)
+        {
+            minSize = options.minSize;
+            maxSize = options.maxSize;
+            colourBound = options.colourBound;
+            bounded = (minSize > 0) || (maxSize != ~(std::size_t)0);
+            if (minSize > maxSize)
+            {
+                /// no size is admitted, and so the search is cut off at its root
+                minSize = 1;
+                maxSize = 0;
+            }
+        }
+
+        /// Delivers any cliques still held in the batch.  Must precede the receiver's onComplete.
+        void flush()
+        {
+            if (batch.count() > 0)
+            {
+                receiver->onCliqueBatch(*graph, batch);
+                batch.clear();
+            }
+        }
+
+        Set* reserveSet()
+        {
+            return next++;
+        }
+
+        void releaseSet()
+        {
+            next--;
+        }
+
+        const DecodedIntegerSet& reserveDecoded(const Set& a)
+        {
+            if (decodedDepth == decoded.size()) decoded.emplace_back();
+            return decoded[decodedDepth++].decode(a);
+        }
+
+        void releaseDecoded()
+        {
+            decodedDepth--;
+        }
+
+        Set* intersect(Set* a, const Set* b)
+        {
+            Set* r = reserveSet();
+            r->intersection(*a, *b);
+            return r;
+        }
+
+        Set* insert(Set* a, std::size_t value)
+        {
+            Set* r = reserveSet();
+            r->copy(*a);
+            r->add(value);
+            return r;
+        }
+
+        /// Enumerates every maximal clique, from a single root with every vertex a candidate.
+        void enumerateCliques()
+        {
+            receiver->reset();
+            receiver->onClear();
+
+            Set* S = reserveSet();
+            Set* P = reserveSet();
+            Set* X = reserveSet();
+
+            S->clear();
+            P->fill();
+            X->clear();
+
+            depth = 0;
+            apply(S, P, X, bounded ? P->count() : !P->isEmpty(), false);
+            // consumed by apply: S, P, X
+
+            flush();
+            receiver->onComplete();
+        }
+
+        /// As BKSearch::apply.
+        void apply(Set* S, Set* P, Set* X, std::size_t candidates, bool excluded)
+        {
+            receiver->recursionCounter++;
+            depth++;
+            stats.enter(depth - 1, *P, *X);
+
+            if (bounded && outOfBounds(S, P, candidates))
+            {
+                /// cut-off: every maximal clique here has the wrong size
+                receiver->sizePrunedCounter++;
+                releaseSet(); // Release X
+                releaseSet(); // Release P
+                releaseSet(); // Release S
+                depth--;
+                return;
+            }
+
+            bool leaf = (candidates == 0) && !excluded;
+            Set* Q = leaf ? nullptr : PivotPolicy::pivotConflict(*this, S, P, X);
+            if (Q)
+            {
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                bool grouped = (Q->countLimit(2) > 1);
+                if (grouped) receiver->onOpenGroup();
+                bool first = true;
+                Graph::Vertex vertex;
+#endif
+
+                const DecodedIntegerSet& conflicts = reserveDecoded(*Q);
+                for (std::size_t v : conflicts)
+                {
+                    P->remove(v);
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                    if (!first) receiver->onPartition();
+                    first = false;
+                    graph->getVertexByIndex(v, vertex);
+                    receiver->onVertex(v, vertex.attrID);
+#endif
+
+                    Set* s2 = insert(S, v);
+                    Set* p2 = reserveSet();
+                    Set* x2 = reserveSet();
+                    std::size_t candidates2 = bounded ? p2->intersectionCount(*P, N[v]) : p2->intersectionAny(*P, N[v]);
+                    bool excluded2 = x2->intersectionAny(*X, N[v]);
+
+                    apply(s2, p2, x2, candidates2, excluded2);
+
+                    X->add(v);
+                }
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                if (first) receiver->onCutOff();
+                if (grouped) receiver->onCloseGroup();
+#endif
+                releaseDecoded();
+                releaseSet(); // Release Q
+            }
+            else
+            if (bounded && !leaf && X->isEmpty() && outOfBounds(S, P, 0))
+            {
+                /// maximal clique found, but pivoting has taken it out of bounds (P is empty by now)
+                receiver->sizePrunedCounter++;
+            }
+            else
+            if (leaf || X->isEmpty())
+            {
+                /// maximal clique found
+                receiver->cliqueCounter++;
+                reportClique(*S);
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                receiver->onOk();
+#endif
+            }
+            else
+            {
+                /// cut-off: sub-maximal clique
+                receiver->cutOffCounter++;
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                receiver->onCutOff();
+#endif
+            }
+
+            releaseSet(); // Release X
+            releaseSet(); // Release P
+            releaseSet(); // Release S
+            depth--;
+        }
+    };
+
+
+    /// The pivot of Tomita et al.: the vertex of P or X with the most neighbours in P.
+    /// The neighbourhoods are scored against P in batches, through IntegerSet::countCommonBatch.
+    struct TomitaPivot
+    {
+        template <typename Search, typename Set>
+        static Set* pivotConflict(Search& engine, Set* S, Set* P, Set* X)
+        {
+            const auto& K = engine.K;
+
+            if (!P->isEmpty())
+            {
+                std::size_t most = 0;
+                std::size_t q = 0;
+
+                score(engine, P, X, most, q);
+                score(engine, P, P, most, q);
+
+                Set* Q = engine.intersect(P, &K[q]);
+
+                return Q;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        /// Raises most, and sets q, for each vertex of among with more neighbours in P than any before it.
+        template <typename Search, typename Set>
+        static void score(Search& engine, const Set* P, const Set* among, std::size_t& most, std::size_t& q)
+        {
+            const auto& N = engine.N;
+            const Set* rows[Set::CountCommonBatchSize];
+            std::size_t vertices[Set::CountCommonBatchSize];
+            std::size_t counts[Set::CountCommonBatchSize];
+
+            const DecodedIntegerSet& elements = engine.reserveDecoded(*among);
+            for (std::size_t first = 0; first < elements.size(); first += Set::CountCommonBatchSize)
+            {
+                std::size_t k = 0;
+                while ((k < Set::CountCommonBatchSize) && (first + k < elements.size()))
+                {
+                    vertices[k] = elements[first + k];
+                    rows[k] = &N[vertices[k]];
+                    k++;
+                }
+
+                P->countCommonBatch(rows, k, counts);
+                engine.stats.scanned(k * P->windowWords());
+                for (std::size_t i = 0; i < k; i++)
+                {
+                    if (counts[i] + 1 > most)
+                    {
+                        most = counts[i] + 1;
+                        q = vertices[i];
+                    }
+                }
+            }
+            engine.releaseDecoded();
+        }
+    };
+
+    /// The pivot of Naudé: the vertex of P or X with the fewest conflicts in P.  Where a single conflict
+    /// remains, that vertex joins S in place instead, and the search for a pivot continues.
+    struct NaudePivot
+    {
+        /// The words read by P.countCommonLimit(row, least, w), which stops early, at the word
+        /// holding w, once the count reaches least.
+        template <typename Set>
+        static std::size_t wordsRead(const Set& P, const Set& row, std::size_t count, std::size_t least, std::size_t w)
+        {
+            std::size_t low, high;
+            P.commonWindow(row, low, high);
+            return (count >= least) ? (w / 64 - low + 1) : (high - low);
+        }
+
+        template <typename Search, typename Set>
+        static Set* pivotConflict(Search& engine, Set* S, Set* P, Set* X)
+        {
+            const auto& N = engine.N;
+            const auto& K = engine.K;
+            std::size_t numVertices = engine.numVertices;
+            bool candidates = !P->isEmpty(); /// kept up to date as vertices join S in place
+            bool excluded = !X->isEmpty();
+
+        search:
+            std::size_t q = numVertices; // an initial value which is not a valid vertex
+            std::size_t least = numVertices + 1; // not infinity, but large enough
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+            Graph::Vertex vertex;
+#endif
+
+            if (excluded)
+            {
+                const DecodedIntegerSet& elements = engine.reserveDecoded(*X);
+                for (std::size_t v : elements)
+                {
+                    if (!X->contains(v)) continue; /// it has left X since X was decoded
+                    std::size_t w = 0;
+                    std::size_t count = P->countCommonLimit(K[v], least, w);
+                    engine.stats.scanned(wordsRead(*P, K[v], count, least, w));
+                    if (count < least)
+                    {
+                        if (count <= 2)
+                        {
+                            if (count != 1) // count in { 0, 2 }
+                            {
+                                q = v;
+                                engine.releaseDecoded();
+                                goto conclude;
+                            }
+                            else
+                            {
+                                /// Process w in place
+                                S->add(w);
+                                candidates = P->intersectWithAny(N[w]);
+                                engine.stats.inPlace();
+                                excluded = X->intersectWithAny(N[w]);
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                                engine.graph->getVertexByIndex(engine.label(w), vertex);
+                                engine.receiver->onVertex(engine.label(w), vertex.attrID);
+#endif
+
+                                /// Very important!
+                                /// We are iterating through X, and we have potentially just modified X.
+                                /// The decoded copy does not see the change, so each vertex is checked
+                                /// against X before it is scored.
+
+                                if ((q < numVertices) && K[w].contains(q))
+                                {
+                                    engine.releaseDecoded();
+                                    goto search;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            q = v;
+                            least = count;
+                        }
+                    }
+                }
+                engine.releaseDecoded();
+            }
+
+            if (candidates)
+            {
+                const DecodedIntegerSet& elements = engine.reserveDecoded(*P);
+                for (std::size_t v : elements)
+                {
+                    if (!P->contains(v)) continue; /// it has left P since P was decoded
+                    std::size_t w = 0;
+                    std::size_t count = P->countCommonLimit(K[v], least, w);
+                    engine.stats.scanned(wordsRead(*P, K[v], count, least, w));
+                    if (count < least)
+                    {
+                        if (count <= 2)
+                        {
+                            if (count != 1) // count in { 0, 2 }
+                            {
+                                q = v;
+                                engine.releaseDecoded();
+                                goto conclude;
+                            }
+                            else
+                            {
+                                /// Process v in place
+                                S->add(v);
+                                candidates = P->intersectWithAny(N[v]);
+                                engine.stats.inPlace();
+                                excluded = X->intersectWithAny(N[v]);
+
+#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
+                                engine.graph->getVertexByIndex(engine.label(v), vertex);
+                                engine.receiver->onVertex(engine.label(v), vertex.attrID);
+#endif
+
+                                /// Very important!
+                                /// We are iterating through P, and we have potentially just modified P.
+                                /// The decoded copy does not see the change, so each vertex is checked
+                                /// against P before it is scored.
+
+                                if ((q < numVertices) && K[v].contains(q))
+                                {
+                                    engine.releaseDecoded();
+                                    goto search;
+                                }
+                            }
+                        }
+                        else
+                        {
+                            q = v;
+                            least = count;
+                        }
+                    }
+                }
+                engine.releaseDecoded();
+            }
+
+        conclude:
+            if (q < numVertices)
+            {
+                Set* Q = engine.intersect(P, &K[q]);
+                return Q;
+            }
+            else
+                return nullptr;
+        }
+    };
+
+
+    /// Forwards the cliques of a parallel worker to a shared receiver which cannot be forked.
+    class SerialisedCliqueReceiver : public CliqueReceiver
+    {
+    private:
+        CliqueReceiver* target;
+        std::mutex* lock;
+
+    public:
+        SerialisedCliqueReceiver(CliqueReceiver* target, std::mutex* lock)
+        {
+            this->target = target;
+            this->lock = lock;
+        }
+
+        virtual void onClique(const Graph& graph, const IntegerSet& vertices)
+        {
+            std::lock_guard<std::mutex> guard(*lock);
+            target->onClique(graph, vertices);
+        }
+
+        virtual std::size_t batchSize()
+        {
+            return target->batchSize();
+        }
+
+        virtual void onCliqueBatch(const Graph& graph, const CliqueBatch& batch)
+        {
+            std::lock_guard<std::mutex> guard(*lock);
+            target->onCliqueBatch(graph, batch);
+        }
+    };
+
+    /// Runs work(receiver, worker) on each of numThreads threads, giving each worker a receiver of its own.
+    template <typename Work>
+    void runWorkers(CliqueReceiver* receiver, unsigned numThreads, Work work)
+    {
+        std::mutex lock;
+
+        std::vector<std::unique_ptr<CliqueReceiver>> receivers;
+        std::vector<bool> forked;
+        for (unsigned w = 0; w < numThreads; w++)
+        {
+            CliqueReceiver* local = receiver->fork();
+            forked.push_back(local != nullptr);
+            if (!local) local = new SerialisedCliqueReceiver(receiver, &lock);
+            receivers.push_back(std::unique_ptr<CliqueReceiver>(local));
+            local->reset();
+            local->onClear();
+        }
+
+        receiver->reset();
+        receiver->onClear();
+
+        std::vector<std::thread> threads;
+        for (unsigned w = 0; w < numThreads; w++)
+        {
+            CliqueReceiver* local = receivers[w].get();
+            threads.push_back(std::thread(work, local, (std::size_t)w));
+        }
+
+        for (unsigned w = 0; w < numThreads; w++)
+        {
+            threads[w].join();
+            receivers[w]->onComplete();
+            receiver->accumulate(*receivers[w]);
+            if (forked[w]) receiver->merge(*receivers[w]);
+        }
+
+        receiver->onComplete();
+    }
+
+    template <typename Search>
+    void parallelEnumerate(const Graph* graph, const Adjacency& adjacency, CliqueReceiver* receiver, unsigned numThreads, const CliqueCheckpoint& plan,
+        BKBudget* budget, CliqueCheckpoint* rest, const CliqueEnumerationOptions& options)
+    {
+        BranchOrder order(adjacency, plan.ordering);
+        BKScheduler scheduler(numThreads, plan.frames.size() + (adjacency.numVertices - plan.nextBranch), budget);
+        std::vector<std::vector<CliqueFrame>> residues(numThreads);
+        std::mutex statsLock;
+
+        runWorkers(receiver, numThreads, [graph, &adjacency, &order, &scheduler, &options, &plan, budget, rest, &residues, &statsLock](CliqueReceiver* local, std::size_t w)
+        {
+            Search search(graph, adjacency, local);
+            search.bound(options);
+            search.limit(budget, rest ? &residues[w] : nullptr);
+            search.work(plan, order, &scheduler, w);
+
+            std::lock_guard<std::mutex> guard(statsLock);
+            search.stats.report(options.statistics);
+        });
+
+        if (rest)
+        {
+            scheduler.collect(plan, *rest);
+            for (std::size_t w = 0; w < numThreads; w++)
+            {
+                rest->frames.insert(rest->frames.end(), residues[w].begin(), residues[w].end());
+            }
+        }
+    }
+
+
+    /**
+    * Runs the top-level branches of an ordered search, each in a compact universe of its own.
+    * The neighbours of the branch vertex are relabelled 0..d-1, candidates first, and rows of d bits
+    * are built for them from the sparse adjacency.  Edges between two excluded vertices are left out,
+    * as the search never consults them.  Everything is reused from one branch to the next.
+    * Frames resumed from a checkpoint are run the same way, over their candidates and excluded vertices.
+    */
+    template <typename Search>
+    class LocalBKSearch
+    {
+    private:
+        static constexpr std::size_t None = ~(std::size_t)0;
+
+        const SparseAdjacency& sparse;
+        const BranchOrder& order;
+
+        Adjacency adjacency;
+        Search search;
+        std::vector<std::size_t> labels; /// the vertex of each local label
+        std::vector<std::size_t> local;  /// the local label of each vertex, or None
+        std::vector<std::size_t> root;   /// the members of S, which lie outside the local universe
+        IntegerSet clique;
+
+        /// Solves the branch with S held in root, labels[0..numCandidates) as P, and the rest of labels as X.
+        void solve(std::size_t numCandidates)
+        {
+            std::size_t d = labels.size();
+
+            for (std::size_t a = 0; a < d; a++)
+            {
+                local[labels[a]] = a;
+            }
+
+            adjacency.reshape(d);
+            for (std::size_t a = 0; a < numCandidates; a++)
+            {
+                sparse.forEachNeighbour(labels[a], [&](std::size_t w)
+                {
+                    std::size_t b = local[w];
+                    if (b != None) adjacency.connect(a, b);
+                });
+            }
+            search.reshape();
+
+            IntegerSet* S = search.reserveSet();
+            IntegerSet* P = search.reserveSet();
+            IntegerSet* X = search.reserveSet();
+
+            S->clear();
+            P->clear();
+            X->clear();
+            for (std::size_t a = 0; a < numCandidates; a++)
+            {
+                P->add(a);
+            }
+            for (std::size_t a = numCandidates; a < d; a++)
+            {
+                X->add(a);
+            }
+
+            for (std::size_t v : root) clique.add(v);
+            search.apply(S, P, X);
+            // consumed by apply: S, P, X
+            for (std::size_t v : root) clique.remove(v);
+
+            for (std::size_t a = 0; a < d; a++)
+            {
+                local[labels[a]] = None;
+            }
+        }
+
+    public:
+        LocalBKSearch(const Graph* graph, const SparseAdjacency& sparse, const BranchOrder& order, typename Search::ReceiverType* receiver) :
+            sparse(sparse), order(order), adjacency((std::size_t)0), search(graph, adjacency, receiver),
+            local(sparse.numVertices, None), clique(std::max<std::size_t>(sparse.numVertices, 1))
+        {
+            search.relabel(&labels, &clique, &root);
+        }
+
+        void bound(const CliqueEnumerationOptions& options)
+        {
+            search.bound(options);
+        }
+
+        void limit(BKBudget* budget, std::vector<CliqueFrame>* residue)
+        {
+            search.limit(budget, residue);
+        }
+
+        bool stopped() const
+        {
+            return search.stopped();
+        }
+
+        void flush()
+        {
+            search.flush();
+        }
+
+        void report(SearchStatistics* into)
+        {
+            search.stats.report(into);
+        }
+
+        void branch(std::size_t k)
+        {
+            std::size_t v = order.vertex(k);
+            root.assign(1, v);
+
+            labels.clear();
+            sparse.forEachNeighbour(v, [&](std::size_t u)
+            {
+                if (order.candidate(v, u)) labels.push_back(u);
+            });
+            std::size_t numCandidates = labels.size();
+            sparse.forEachNeighbour(v, [&](std::size_t u)
+            {
+                if (!order.candidate(v, u)) labels.push_back(u);
+            });
+
+            solve(numCandidates);
+        }
+
+        void resume(const CliqueFrame& frame)
+        {
+            root = frame.S;
+            labels = frame.P;
+            labels.insert(labels.end(), frame.X.begin(), frame.X.end());
+
+            solve(frame.P.size());
+        }
+    };
+
+    template <typename Search>
+    constexpr std::size_t LocalBKSearch<Search>::None;
+
+    /// Serial runs use Search, whose receiver type is that of receiver; parallel workers use WorkerSearch.
+    template <typename Search, typename WorkerSearch>
+    void localEnumerate(const CsrGraph& csr, typename Search::ReceiverType* receiver, unsigned numThreads, const CliqueCheckpoint& plan,
+        BKBudget* budget, CliqueCheckpoint* rest, const CliqueEnumerationOptions& options)
+    {
+        const Graph* graph = &csr.getGraph();
+        SparseAdjacency sparse(csr);
+        BranchOrder order(sparse, plan.ordering);
+        std::size_t numFrames = plan.frames.size();
+
+        if (numThreads == 1)
+        {
+            receiver->reset();
+            receiver->onClear();
+            LocalBKSearch<Search> search(graph, sparse, order, receiver);
+            search.bound(options);
+            search.limit(budget, rest ? &rest->frames : nullptr);
+
+            std::size_t f = 0;
+            for (; (f < numFrames) && !search.stopped(); f++)
+            {
+                search.resume(plan.frames[f]);
+            }
+            std::size_t k = plan.nextBranch;
+            for (; (k < sparse.numVertices) && !search.stopped(); k++)
+            {
+                search.branch(k);
+            }
+
+            if (rest)
+            {
+                rest->frames.insert(rest->frames.end(), plan.frames.begin() + f, plan.frames.end());
+                rest->nextBranch = k;
+            }
+            search.report(options.statistics);
+            search.flush();
+            receiver->onComplete();
+            return;
+        }
+
+        BKScheduler scheduler(numThreads, numFrames + (sparse.numVertices - plan.nextBranch), budget);
+        std::vector<std::vector<CliqueFrame>> residues(numThreads);
+        std::mutex statsLock;
+
+        runWorkers(receiver, numThreads, [graph, &sparse, &order, &scheduler, &options, &plan, budget, rest, &residues, &statsLock](CliqueReceiver* local, std::size_t w)
+        {
+            LocalBKSearch<WorkerSearch> search(graph, sparse, order, local);
+            search.bound(options);
+            search.limit(budget, rest ? &residues[w] : nullptr);
+            std::unique_ptr<BKTask> task; /// never spawned, as local searches do not split
+            std::size_t r;
+            while (scheduler.acquire(w, task, r))
+            {
+                if (r < plan.frames.size())
+                    search.resume(plan.frames[r]);
+                else
+                    search.branch(plan.nextBranch + (r - plan.frames.size()));
+                scheduler.complete();
+            }
+            search.flush();
+
+            std::lock_guard<std::mutex> guard(statsLock);
+            search.report(options.statistics);
+        });
+
+        if (rest)
+        {
+            scheduler.collect(plan, *rest);
+            for (std::size_t w = 0; w < numThreads; w++)
+            {
+                rest->frames.insert(rest->frames.end(), residues[w].begin(), residues[w].end());
+            }
+        }
+    }
+
+    /// Runs FixedBKSearch over sets of Words words, for the small graphs that fit them.
+    template <std::size_t Words, typename PivotPolicy, typename Receiver, typename Stats>
+    void fixedEnumerate(const CsrGraph& graph, bool complement, Receiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        FixedBKSearch<Words, PivotPolicy, Receiver, Stats> alg(graph, complement, receiver);
+        alg.bound(options);
+        alg.enumerateCliques();
+        alg.stats.report(options.statistics);
+    }
+
+    /**
+    * Enumerates the maximal cliques of graph, or of its complement, with the given pivot rule, as
+    * configured by options.  The serial search is specialised for Receiver.  Parallel workers report
+    * through receivers obtained from fork(), and so are specialised for CliqueReceiver alone.  With
+    * Stats set to SearchStatsCollector, the counts of the search tree are added to options.statistics.
+    * The complement of a sparse graph is dense, so there options.localBranches is ignored.
+    */
+    template <typename PivotPolicy, typename Receiver, typename Stats>
+    void MaximalCliques(const CsrGraph& csr, bool complement, Receiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        typedef BKSearch<PivotPolicy, Receiver, Stats> Search;
+        typedef BKSearch<PivotPolicy, CliqueReceiver, Stats> WorkerSearch;
+
+        const Graph* graph = &csr.getGraph();
+        std::size_t n = csr.countVertices();
+        unsigned numThreads = options.numThreads;
+        if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        bool parallel = (numThreads != 1) && (n > 1);
+        bool local = options.localBranches && !complement;
+
+        /// A small graph is searched over sets of fixed width, unless it asks for more than a plain search.
+        if ((n > 0) && (n <= FixedIntegerSet<4>::Capacity) && !parallel && !local && (options.ordering == BranchOrdering::None) &&
+            !options.resume && !options.checkpoint && !BKBudget::limits(options))
+        {
+            if (n <= FixedIntegerSet<1>::Capacity)
+                fixedEnumerate<1, PivotPolicy, Receiver, Stats>(csr, complement, receiver, options);
+            else
+            if (n <= FixedIntegerSet<2>::Capacity)
+                fixedEnumerate<2, PivotPolicy, Receiver, Stats>(csr, complement, receiver, options);
+            else
+                fixedEnumerate<4, PivotPolicy, Receiver, Stats>(csr, complement, receiver, options);
+            return;
+        }
+
+        /// The work to be done: the frames left by an earlier run, and then the top-level branches
+        /// from nextBranch on.  A fresh unordered search is a single frame, with every vertex a candidate.
+        CliqueCheckpoint plan;
+        if (options.resume)
+        {
+            if (options.resume->numVertices != n)
+                throw std::invalid_argument("CliqueCheckpoint does not match the graph");
+            plan = *options.resume;
+        }
+        else
+        {
+            plan.ordering = options.ordering;
+            plan.numVertices = n;
+            if (plan.ordering == BranchOrdering::None)
+            {
+                if (local)
+                    plan.ordering = BranchOrdering::Degeneracy;
+                else
+                if (parallel)
+                    plan.ordering = BranchOrdering::Index;
+                else
+                {
+                    CliqueFrame root;
+                    for (std::size_t v = 0; v < n; v++)
+                    {
+                        root.P.push_back(v);
+                    }
+                    plan.frames.push_back(std::move(root));
+                    plan.nextBranch = n;
+                }
+            }
+        }
+
+        CliqueCheckpoint* rest = options.checkpoint;
+        if (rest)
+        {
+            rest->ordering = plan.ordering;
+            rest->numVertices = n;
+            rest->nextBranch = n;
+            rest->frames.clear();
+        }
+        std::unique_ptr<BKBudget> budget(BKBudget::limits(options) ? new BKBudget(options) : nullptr);
+
+        if (local)
+        {
+            localEnumerate<Search, WorkerSearch>(csr, receiver, numThreads, plan, budget.get(), rest, options);
+        }
+        else
+        if (parallel)
+        {
+            Adjacency adjacency(csr, complement);
+            parallelEnumerate<WorkerSearch>(graph, adjacency, receiver, numThreads, plan, budget.get(), rest, options);
+        }
+        else
+        {
+            Adjacency adjacency(csr, complement);
+            Search alg(graph, adjacency, receiver);
+            alg.bound(options);
+            alg.limit(budget.get(), nullptr);
+
+            alg.enumerateCliques(plan, rest);
+            alg.stats.report(options.statistics);
+        }
+    }
+
+    /// The Graph is first frozen, so that its adjacency rows are built from sorted neighbour lists.
+    template <typename PivotPolicy, typename Receiver, typename Stats>
+    void MaximalCliques(const Graph* graph, bool complement, Receiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        MaximalCliques<PivotPolicy, Receiver, Stats>(CsrGraph(*graph), complement, receiver, options);
+    }
+
+    template <typename PivotPolicy, typename Receiver, typename Stats = NoSearchStats>
+    void AllCliques(const Graph* graph, Receiver* receiver, const CliqueEnumerationOptions& options = CliqueEnumerationOptions())
+    {
+        MaximalCliques<PivotPolicy, Receiver, Stats>(graph, false, receiver, options);
+    }
+
+    /// Enumerates the maximal independent sets of graph, as the maximal cliques of its complement,
+    /// which is never built: the search simply runs over the rows N and K with their roles swapped.
+    template <typename PivotPolicy, typename Receiver, typename Stats = NoSearchStats>
+    void AllIndependentSets(const Graph* graph, Receiver* receiver, const CliqueEnumerationOptions& options = CliqueEnumerationOptions())
+    {
+        MaximalCliques<PivotPolicy, Receiver, Stats>(graph, true, receiver, options);
+    }
+
+    template <typename PivotPolicy, typename Receiver, typename Stats = NoSearchStats>
+    void AllCliques(const CsrGraph& graph, Receiver* receiver, const CliqueEnumerationOptions& options = CliqueEnumerationOptions())
+    {
+        MaximalCliques<PivotPolicy, Receiver, Stats>(graph, false, receiver, options);
+    }
+
+    template <typename PivotPolicy, typename Receiver, typename Stats = NoSearchStats>
+    void AllIndependentSets(const CsrGraph& graph, Receiver* receiver, const CliqueEnumerationOptions& options = CliqueEnumerationOptions())
+    {
+        MaximalCliques<PivotPolicy, Receiver, Stats>(graph, true, receiver, options);
+    }
+
+
+    /// Gathers the cliques reported to it as lists of vertex indices, in increasing order.
+    class CliqueCollector final : public CliqueReceiver
+    {
+    public:
+        std::vector<std::vector<uint32_t>> cliques;
+
+        virtual std::size_t batchSize() { return 256; }
+
+        virtual void onCliqueBatch(const Graph& graph, const CliqueBatch& batch)
+        {
+            for (std::size_t i = 0; i < batch.count(); i++)
+            {
+                cliques.push_back(std::vector<uint32_t>(batch.begin(i), batch.end(i)));
+            }
+        }
+    };
+
+    /**
+    * Maintains the maximal cliques of a graph as its edges change, reporting only those created or
+    * destroyed by each batch of changes.  Any such clique contains an endpoint of a changed edge: it
+    * either holds an inserted edge, or lost (or gained) maximality through a deleted edge at one of
+    * its members.  So the maximal cliques through the touched endpoints are enumerated before and
+    * after the batch is applied to the rows N and K, each once (from its first touched vertex),
+    * and the two lists are compared.  The rest of the graph is never searched.
+    */
+    template <typename PivotPolicy = NaudePivot>
+    class IncrementalCliques
+    {
+    private:
+        const Graph* graph;
+        Adjacency adjacency;
+        CliqueCollector collector;
+        BKSearch<PivotPolicy, CliqueCollector> search;
+
+        /// Lists the maximal cliques which contain a vertex of touched, in lexicographic order.
+        void touchedCliques(const std::vector<std::size_t>& touched, std::vector<std::vector<uint32_t>>& cliques)
+        {
+            for (std::size_t i = 0; i < touched.size(); i++)
+            {
+                std::size_t t = touched[i];
+                IntegerSet* S = search.reserveSet();
+                IntegerSet* P = search.reserveSet();
+                IntegerSet* X = search.reserveSet();
+
+                S->clear();
+                S->add(t);
+                P->copy(adjacency.N[t]);
+                X->clear();
+                for (std::size_t j = 0; j < i; j++)
+                {
+                    if (P->contains(touched[j]))
+                    {
+                        P->remove(touched[j]);
+                        X->add(touched[j]);
+                    }
+                }
+
+                search.apply(S, P, X);
+                // consumed by apply: S, P, X
+            }
+            search.flush();
+
+            cliques.clear();
+            cliques.swap(collector.cliques);
+            std::sort(cliques.begin(), cliques.end());
+        }
+
+        void report(const std::vector<std::vector<uint32_t>>& cliques, CliqueChangeReceiver* receiver, bool created)
+        {
+            IntegerSet vertices(std::max<std::size_t>(adjacency.numVertices, 1));
+            for (const std::vector<uint32_t>& clique : cliques)
+            {
+                vertices.clear();
+                for (uint32_t v : clique)
+                {
+                    vertices.add(v);
+                }
+
+                if (created)
+                    receiver->onCliqueCreated(*graph, vertices);
+                else
+                    receiver->onCliqueDestroyed(*graph, vertices);
+            }
+        }
+
+    public:
+        /// Takes a copy of the adjacency of graph, which is then kept up to date by update alone.
+        IncrementalCliques(const Graph* graph) :
+            graph(graph), adjacency(graph), search(graph, adjacency, &collector) {}
+
+        bool isEdge(std::size_t u, std::size_t v) const
+        {
+            return adjacency.N[u].contains(v);
+        }
+
+        /**
+        * Applies a batch of changes, given as pairs of vertex IDs (as for Graph::addEdge), and reports
+        * the maximal cliques created and destroyed.  Removals are applied before insertions.  Pairs naming
+        * an unknown vertex, or a vertex twice, are ignored.  The graph itself is left for the caller to
+        * update; its vertices must stay as they were.
+        */
+        void update(const std::vector<Graph::Pair>& inserted, const std::vector<Graph::Pair>& removed, CliqueChangeReceiver* receiver)
+        {
+            std::vector<std::size_t> touched;
+            std::vector<std::pair<std::size_t, std::size_t>> insertions;
+            std::vector<std::pair<std::size_t, std::size_t>> removals;
+
+            auto endpoints = [&](const std::vector<Graph::Pair>& pairs, std::vector<std::pair<std::size_t, std::size_t>>& edges)
+            {
+                for (const Graph::Pair& pair : pairs)
+                {
+                    if ((pair.u == pair.v) || !graph->validVertexID(pair.u) || !graph->validVertexID(pair.v)) continue;
+
+                    std::size_t u = graph->getVertexIndex(pair.u);
+                    std::size_t v = graph->getVertexIndex(pair.v);
+                    edges.push_back(std::make_pair(u, v));
+                    touched.push_back(u);
+                    touched.push_back(v);
+                }
+            };
+            endpoints(removed, removals);
+            endpoints(inserted, insertions);
+
+            std::sort(touched.begin(), touched.end());
+            touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+            if (touched.empty()) return;
+
+            std::vector<std::vector<uint32_t>> before;
+            touchedCliques(touched, before);
+
+            for (auto& e : removals)
+            {
+                adjacency.disconnect(e.first, e.second);
+            }
+            for (auto& e : insertions)
+            {
+                adjacency.connect(e.first, e.second);
+            }
+
+            std::vector<std::vector<uint32_t>> after;
+            touchedCliques(touched, after);
+
+            std::vector<std::vector<uint32_t>> changed;
+            std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(changed));
+            report(changed, receiver, false);
+
+            changed.clear();
+            std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(changed));
+            report(changed, receiver, true);
+        }
+    };
+
+}
@@ -13,6 +13,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cassert>
+#include <vector>
 
 namespace kn
 {
@@ -90,24 +91,54 @@ namespace kn
         return singleBit(highestBitIndex(bits));
     }
 
+    /// Uses the POPCNT instruction where the build targets it, and otherwise counts bits in parallel
+    /// within the word, which beats a byte table.  The bulk operations of IntegerSet do not rely on
+    /// this; they choose hardware kernels at run time (see BitKernels).
     inline int countBits(uint64_t bits)
     {
-        return
-            BitCountTable[bits & 255] +
-            BitCountTable[(bits >> 8) & 255] +
-            BitCountTable[(bits >> 16) & 255] +
-            BitCountTable[(bits >> 24) & 255] +
-            BitCountTable[(bits >> 32) & 255] +
-            BitCountTable[(bits >> 40) & 255] +
-            BitCountTable[(bits >> 48) & 255] +
-            BitCountTable[(bits >> 56) & 255];
+#if defined(__POPCNT__)
+        return __builtin_popcountll(bits);
+#else
+        bits = bits - ((bits >> 1) & UINT64_C(0x5555555555555555));
+        bits = (bits & UINT64_C(0x3333333333333333)) + ((bits >> 2) & UINT64_C(0x3333333333333333));
+        bits = (bits + (bits >> 4)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+        return (int)((bits * UINT64_C(0x0101010101010101)) >> 56);
+#endif
     }
 
+    /**
+    * The kernels behind the bulk operations of IntegerSet (count, countCommon, countCommonLimit,
+    * countCommonBatch, intersection, intersectWith and removeAll, the fused intersections, and decode).
+    * The best supported by the processor is chosen once, at startup, through CPUID.
+    * selectBitKernels overrides the choice, for comparisons, and returns false (changing nothing)
+    * if the processor lacks support.  It should not be called while other threads are using sets.
+    */
+    enum class BitKernels
+    {
+        Portable,   /// plain word loops
+        Popcnt,     /// word loops with the POPCNT instruction
+        AVX2,       /// 256-bit vectors, counting bits by nibble lookup
+        AVX512      /// 512-bit vectors with VPOPCNTDQ, and masked tails
+    };
+
+    BitKernels activeBitKernels();
+    bool supportsBitKernels(BitKernels kernels);
+    bool selectBitKernels(BitKernels kernels);
+    const char* bitKernelsName(BitKernels kernels);
+
 
     /**
     * The IntegerSet provides a fast implementation of a set of non-negative integers,
     * by means of a bit vector. Each binary digit designates the presence or absence
     * of a candidate element.
+    *
+    * Sets over a universe of at least WindowWords words also track a window of words,
+    * [lowWord, highWord), outside of which every word is zero.  Bulk operations and iteration are
+    * confined to the window, and intersections narrow it to the overlap of their operands and then
+    * trim its zero ends, so that the sets of deep search levels cost in proportion to the range they
+    * span rather than the universe.  The window is conservative: add widens it, but remove leaves it
+    * as is.  Smaller sets keep the window fixed at every word, as the bookkeeping would cost more
+    * than the words it saves.
     */
     class IntegerSet
     {
@@ -115,8 +146,11 @@ namespace kn
         /**
         * The IntegerSet Iterator provides fast iteration through the elements of a bit vector.
         * If the bit vector is sparse, the iteration remains fairly efficient by the following:
+        *   - only the words within the window of the set are visited
         *   - zero words are skipped immediately (skipping 64 possible entries at once)
         *   - non-zero words are processed in O(n), where n is the number of bits set in the word.
+        * Elements may be removed during the iteration, but elements added beyond the window (as it
+        * stood when the iteration began) will not be visited.
         */
         struct Iterator
         {
@@ -125,32 +159,32 @@ namespace kn
 
             uint64_t* array;
 
-            std::size_t arraySize;
+            std::size_t highWord;
             std::size_t currentIndex;
 
             std::size_t currentBaseValue;
             uint64_t currentBits;
             uint64_t currentMask;
 
-            Iterator(uint64_t* array, std::size_t arraySize)
+            Iterator(uint64_t* array, std::size_t lowWord, std::size_t highWord)
             {
                 this->array = array;
-                this->arraySize = arraySize;
+                this->highWord = highWord;
 
-                currentIndex = 0;
-                currentBaseValue = 0;
-                currentBits = (arraySize) ? array[0] : 0;
+                currentIndex = lowWord;
+                currentBaseValue = lowWord * 64;
+                currentBits = (lowWord < highWord) ? array[lowWord] : 0;
                 currentMask = 0xFFFFFFFFFFFFFFFFULL;
             }
 
         public:
             bool hasNext()
             {
-                if (currentIndex < arraySize)
+                if (currentIndex < highWord)
                 {
                     currentBits = array[currentIndex] & currentMask;
                 }
-                while ((currentBits == 0) && (currentIndex + 1 < arraySize))
+                while ((currentBits == 0) && (currentIndex + 1 < highWord))
                 {
                     currentIndex++;
                     currentBits = array[currentIndex];
@@ -171,12 +205,76 @@ namespace kn
         };
 
     private:
+        friend class CompressedIntegerSet;
+        friend class IntegerSetPool;
+
         std::size_t maxCardinality;
         std::size_t arraySize;
         uint64_t* array;
+        bool ownsArray;         /// false for a view into the slab of an IntegerSetPool
+        std::size_t lowWord;    /// every word before lowWord is zero
+        std::size_t highWord;   /// every word from highWord on is zero; the window is empty when lowWord >= highWord
+        bool windowed;          /// whether the window is tracked, rather than fixed at every word
 
         bool verifyIsEmpty() const;
 
+        /// Makes the set an empty view of the given words, which must already be zero.
+        IntegerSet(uint64_t* words, std::size_t maxCardinality);
+        void attach(uint64_t* words, std::size_t maxCardinality);
+
+        /// Fixes the window at every word, or empties it, as the size of the universe dictates.
+        void resetWindow()
+        {
+            windowed = (arraySize >= WindowWords);
+            lowWord = 0;
+            highWord = windowed ? 0 : arraySize;
+        }
+
+        /// Grows the window to cover the words [low, high).
+        void widen(std::size_t low, std::size_t high)
+        {
+            if (!windowed || (low >= high)) return;
+            if (lowWord >= highWord)
+            {
+                lowWord = low;
+                highWord = high;
+            }
+            else
+            {
+                if (low < lowWord) lowWord = low;
+                if (high > highWord) highWord = high;
+            }
+        }
+
+        /// Narrows the window to the words [low, high), zeroing those of the old window it leaves behind.
+        void narrow(std::size_t low, std::size_t high)
+        {
+            if (!windowed) return;
+            if (low >= high)
+            {
+                clear();
+                return;
+            }
+            for (std::size_t index = lowWord; index < std::min(highWord, low); index++)
+            {
+                array[index] = 0;
+            }
+            for (std::size_t index = std::max(lowWord, high); index < highWord; index++)
+            {
+                array[index] = 0;
+            }
+            lowWord = low;
+            highWord = high;
+        }
+
+        /// Drops the zero words at either end of the window.
+        void trim()
+        {
+            if (!windowed) return;
+            while ((lowWord < highWord) && (array[lowWord] == 0)) lowWord++;
+            while ((lowWord < highWord) && (array[highWord - 1] == 0)) highWord--;
+        }
+
         void sanitiseHighBits()
         {
             /// Here, I correct for a cardinality that does not lie on a 64-bit boundary.
@@ -187,6 +285,8 @@ namespace kn
         }
 
     public:
+        static const std::size_t WindowWords = 64;
+
         IntegerSet();
         IntegerSet(std::size_t maxCardinality);
         IntegerSet(const IntegerSet& pattern);
@@ -199,7 +299,12 @@ namespace kn
 
         Iterator iterator() const
         {
-            return Iterator(array, arraySize);
+            return Iterator(array, lowWord, highWord);
+        }
+
+        std::size_t getMaxCardinality() const
+        {
+            return maxCardinality;
         }
 
         void setMaxCardinality(std::size_t maxCardinality);
@@ -211,6 +316,7 @@ namespace kn
             std::size_t index = value / 64;
             uint64_t bit = singleBit(value % 64);
             array[index] |= bit;
+            widen(index, index + 1);
         }
 
         void remove(std::size_t value)
@@ -233,15 +339,17 @@ namespace kn
 
         bool isEmpty() const
         {
-            return (array[0] == 0) && verifyIsEmpty();
+            return (lowWord >= highWord) || ((array[lowWord] == 0) && verifyIsEmpty());
         }
 
         std::size_t firstElement() const
         {
-            std::size_t currentIndex = 0;
-            std::size_t currentBaseValue = 0;
+            if (lowWord >= highWord) return maxCardinality;
+
+            std::size_t currentIndex = lowWord;
+            std::size_t currentBaseValue = lowWord * 64;
             uint64_t currentBits = array[currentIndex];
-            while ((currentBits == 0) && (currentIndex + 1 < arraySize))
+            while ((currentBits == 0) && (currentIndex + 1 < highWord))
             {
                 currentIndex++;
                 currentBits = array[currentIndex];
@@ -257,10 +365,12 @@ namespace kn
 
         std::size_t lastElement() const
         {
-            std::size_t currentIndex = arraySize - 1;
+            if (lowWord >= highWord) return maxCardinality;
+
+            std::size_t currentIndex = highWord - 1;
             std::size_t currentBaseValue = currentIndex * 64;
             uint64_t currentBits = array[currentIndex];
-            while ((currentBits == 0) && (currentIndex > 0))
+            while ((currentBits == 0) && (currentIndex > lowWord))
             {
                 currentIndex--;
                 currentBits = array[currentIndex];
@@ -279,6 +389,9 @@ namespace kn
         void fillBefore(std::size_t value);
         void fillAfter(std::size_t value);
 
+        /// Removes value, and moves each element above it down by one, as when an index is deleted.
+        void removeShift(std::size_t value);
+
         void copy(const IntegerSet& b);
 
         std::size_t count() const;
@@ -286,6 +399,25 @@ namespace kn
         std::size_t countCommon(const IntegerSet& b) const;
         std::size_t countCommonLimit(const IntegerSet& b, std::size_t limit, std::size_t& w) const;
 
+        /// The words [low, high) which countCommon and countCommonLimit read against b: the overlap
+        /// of the two windows, or every word if the sets are not windowed.
+        void commonWindow(const IntegerSet& b, std::size_t& low, std::size_t& high) const
+        {
+            low = windowed ? std::max(lowWord, b.lowWord) : 0;
+            high = windowed ? std::min(highWord, b.highWord) : arraySize;
+            if (high < low) high = low;
+        }
+
+        /// The number of words in the window, which countCommonBatch reads against each row.
+        std::size_t windowWords() const
+        {
+            return (lowWord < highWord) ? (highWord - lowWord) : 0;
+        }
+
+        /// Whether every word outside the window is zero, as is every bit from maxCardinality on.
+        /// This holds after every operation; it is checked by DevTest.
+        bool verifyWindow() const;
+
         void invert();
 
         void intersectWith(const IntegerSet& b);
@@ -295,6 +427,22 @@ namespace kn
 
         void intersection(const IntegerSet& a, const IntegerSet& b);
 
+        /// As intersection and intersectWith, also reporting what the result holds in the same pass:
+        /// its cardinality, or merely whether it is non-empty (which is cheaper still).
+        std::size_t intersectionCount(const IntegerSet& a, const IntegerSet& b);
+        bool intersectionAny(const IntegerSet& a, const IntegerSet& b);
+        bool intersectWithAny(const IntegerSet& b);
+
+        /// Sets counts[r] to countCommon(*rows[r]) for each of the numRows rows, reading this set once
+        /// for a whole batch of rows rather than once per row, and skipping its empty words.
+        static const std::size_t CountCommonBatchSize = 64;
+        void countCommonBatch(const IntegerSet* const* rows, std::size_t numRows, std::size_t* counts) const;
+
+        /// Writes the elements to out in increasing order, a word at a time, and returns how many there are.
+        /// The vector kernels store whole registers, so out must have room for DecodePadding values more.
+        static const std::size_t DecodePadding = 16;
+        std::size_t decode(uint32_t* out) const;
+
         /*
         void list(const char* head)
         {
@@ -315,4 +463,126 @@ namespace kn
 
     };
 
+
+    /**
+    * A DecodedIntegerSet holds the elements of an IntegerSet as an array of indices, decoded in bulk,
+    * for loops which visit every element: a range-based for steps through the array rather than
+    * searching the words bit by bit.  It is a snapshot, so changes to the set after decode are not
+    * seen.  The buffer is kept from one decode to the next, so one object may serve many sets.
+    */
+    class DecodedIntegerSet
+    {
+    private:
+        std::vector<uint32_t> buffer;
+        std::size_t length;
+
+    public:
+        DecodedIntegerSet()
+            : length(0)
+        {
+        }
+
+        template <typename Set>
+        explicit DecodedIntegerSet(const Set& set)
+            : length(0)
+        {
+            decode(set);
+        }
+
+        /// Set is IntegerSet, or another set with its decode, such as FixedIntegerSet.
+        template <typename Set>
+        DecodedIntegerSet& decode(const Set& set)
+        {
+            std::size_t room = set.getMaxCardinality() + IntegerSet::DecodePadding;
+            if (buffer.size() < room) buffer.resize(room);
+            length = set.decode(buffer.data());
+            return *this;
+        }
+
+        const uint32_t* begin() const
+        {
+            return buffer.data();
+        }
+
+        const uint32_t* end() const
+        {
+            return buffer.data() + length;
+        }
+
+        std::size_t size() const
+        {
+            return length;
+        }
+
+        uint32_t operator[](std::size_t index) const
+        {
+            return buffer[index];
+        }
+    };
+
+
+    /**
+    * An IntegerSetPool holds many sets of one maximum cardinality in a single slab of memory,
+    * aligned to 64 bytes, in place of one heap allocation per set.  Each set is padded to whole
+    * cache lines, so that consecutive sets (such as the frames of a search) lie side by side.
+    * When asked, the slab is mapped onto huge pages where the system allows, and otherwise onto
+    * ordinary ones.  The sets are views into the slab: they must not outlive the pool, and any
+    * change to their maximum cardinality moves them out of it.
+    */
+    class IntegerSetPool
+    {
+    private:
+        uint64_t* slab;
+        std::size_t capacity;   /// the words in the slab
+        std::size_t mapped;     /// the bytes mapped for the slab, or zero if it came from the heap
+        bool hugePages;         /// whether huge pages are wanted
+        bool onHugePages;       /// whether the slab lies on explicitly reserved huge pages
+        std::vector<IntegerSet> sets;
+
+        void release();
+
+    public:
+        /// Words per set are rounded up to a multiple of StrideWords, a cache line.
+        static const std::size_t StrideWords = 8;
+
+        IntegerSetPool(bool hugePages = false);
+        IntegerSetPool(std::size_t count, std::size_t maxCardinality, bool hugePages = false);
+        ~IntegerSetPool();
+
+        IntegerSetPool(const IntegerSetPool&) = delete;
+        IntegerSetPool& operator=(const IntegerSetPool&) = delete;
+
+        IntegerSetPool(IntegerSetPool&& pattern);
+        IntegerSetPool& operator=(IntegerSetPool&& pattern);
+
+        /// Provides count empty sets of the given maximum cardinality.  The slab is kept if it is large enough.
+        void reshape(std::size_t count, std::size_t maxCardinality);
+
+        std::size_t size() const
+        {
+            return sets.size();
+        }
+
+        IntegerSet& operator[](std::size_t index)
+        {
+            return sets[index];
+        }
+
+        const IntegerSet& operator[](std::size_t index) const
+        {
+            return sets[index];
+        }
+
+        /// The sets are contiguous, so this may be used as an array.
+        IntegerSet* data()
+        {
+            return sets.data();
+        }
+
+        bool usesHugePages() const
+        {
+            return onHugePages;
+        }
+    };
+
 }
@@ -10,41 +10,101 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <stack>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include <assert.h>
 #include <BitStructures.hpp>
 #include <Graph.hpp>
+#include <CsrGraph.hpp>
 
 namespace kn
 {
 
+    /**
+    * A batch of cliques, each a list of vertex indices in increasing order.  Clique i occupies
+    * vertices[offsets[i]] up to (but excluding) vertices[offsets[i+1]].  The storage is reused from
+    * one batch to the next, so a receiver must copy out whatever it wishes to keep.
+    */
+    struct CliqueBatch
+    {
+        std::vector<uint32_t> vertices;
+        std::vector<std::size_t> offsets;
+
+        CliqueBatch() : offsets(1, 0) {}
+
+        std::size_t count() const { return offsets.size() - 1; }
+        std::size_t size(std::size_t i) const { return offsets[i + 1] - offsets[i]; }
+        const uint32_t* begin(std::size_t i) const { return vertices.data() + offsets[i]; }
+        const uint32_t* end(std::size_t i) const { return vertices.data() + offsets[i + 1]; }
+
+        void clear()
+        {
+            vertices.clear();
+            offsets.resize(1);
+        }
+    };
+
     class CliqueReceiver
     {
     private:
-        friend class BKSearch;
+        template <typename PivotPolicy, typename Receiver, typename Stats> friend class BKSearch;
+        template <std::size_t Words, typename PivotPolicy, typename Receiver, typename Stats> friend class FixedBKSearch;
+        friend class MaximumCliqueSearch;
         uint64_t cliqueCounter = 0;
         uint64_t recursionCounter = 0;
         uint64_t cutOffCounter = 0;
+        uint64_t sizePrunedCounter = 0;
 
     public:
+        virtual ~CliqueReceiver() {}
+
         void reset()
         {
             cliqueCounter = 0;
             recursionCounter = 0;
             cutOffCounter = 0;
+            sizePrunedCounter = 0;
+        }
+
+        /// Adds the counters of another receiver to this one.
+        void accumulate(const CliqueReceiver& other)
+        {
+            cliqueCounter += other.cliqueCounter;
+            recursionCounter += other.recursionCounter;
+            cutOffCounter += other.cutOffCounter;
+            sizePrunedCounter += other.sizePrunedCounter;
         }
 
         uint64_t cliqueCount() { return cliqueCounter; }
         uint64_t recursionCount() { return recursionCounter; }
         uint64_t cutOffCount() { return cutOffCounter; }
+        uint64_t sizePrunedCount() { return sizePrunedCounter; } /// branches cut, and cliques withheld, by size bounds
+
+        /**
+        * Parallel enumeration gives each worker thread a receiver of its own, obtained from fork().
+        * When fork() returns nullptr (the default), the workers instead share this receiver, and
+        * their calls to onClique are serialised.  Forked receivers are handed back through merge()
+        * once their worker is done; their counters have been accumulated by then.
+        */
+        virtual CliqueReceiver* fork() { return nullptr; }
+        virtual void merge(CliqueReceiver& worker) {}
 
         virtual void onClear() {}
 
         virtual void onClique(const Graph& graph, const IntegerSet& vertices) {}
 
+        /**
+        * A receiver opts into batched delivery by returning a non-zero batch size.  The enumerators
+        * then call onCliqueBatch, instead of onClique, once per batchSize cliques, and once more for
+        * any that remain before onComplete.  The batch size is consulted when enumeration begins.
+        */
+        virtual std::size_t batchSize() { return 0; }
+        virtual void onCliqueBatch(const Graph& graph, const CliqueBatch& batch) {}
+
         virtual void onOpenGroup() {}
         virtual void onPartition() {}
         virtual void onCloseGroup() {}
@@ -56,6 +116,20 @@ namespace kn
         virtual void onComplete() {}
     };
 
+    /// A receiver which only counts.  It forks freely, so parallel workers never contend for it.
+    class CountingCliqueReceiver final : public CliqueReceiver
+    {
+    private:
+        std::size_t batch;
+
+    public:
+        /// With a non-zero batch, cliques are delivered (and ignored) in batches of that size.
+        CountingCliqueReceiver(std::size_t batch = 0) : batch(batch) {}
+
+        virtual CliqueReceiver* fork() { return new CountingCliqueReceiver(batch); }
+        virtual std::size_t batchSize() { return batch; }
+    };
+
     class PrettyPrintCliqueReceiver : public CliqueReceiver
     {
     private:
@@ -130,8 +204,214 @@ namespace kn
         }
     };
 
+    /// Receives the maximal cliques created and destroyed by a batch of edge changes; see IncrementalCliques in BKSearch.hpp.
+    class CliqueChangeReceiver
+    {
+    public:
+        virtual ~CliqueChangeReceiver() {}
+
+        virtual void onCliqueCreated(const Graph& graph, const IntegerSet& vertices) {}
+        virtual void onCliqueDestroyed(const Graph& graph, const IntegerSet& vertices) {}
+    };
+
+    /// The order in which the top-level branches of the search are taken.
+    enum class BranchOrdering
+    {
+        None,       /// a single root branch, with every vertex a candidate
+        Index,      /// one branch per vertex, in index order
+        Degeneracy  /// one branch per vertex, in a degeneracy order, which bounds the candidates of each branch
+    };
+
+    /// Lets one thread ask an enumeration running on another to stop.
+    class CancellationToken
+    {
+    private:
+        std::atomic<bool> cancelled;
+
+    public:
+        CancellationToken() : cancelled(false) {}
+
+        void cancel() { cancelled.store(true); }
+        void reset() { cancelled.store(false); }
+        bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+    };
+
+    /**
+    * A branch of the search, in terms of vertex indices: the maximal cliques which contain all of S,
+    * lie within S and P, and cannot be extended by any vertex of X.
+    */
+    struct CliqueFrame
+    {
+        std::vector<std::size_t> S;
+        std::vector<std::size_t> P;
+        std::vector<std::size_t> X;
+    };
+
+    /**
+    * The work left over by an enumeration which was stopped early: the branches it had begun but
+    * not finished, and the first of the top-level branches (taken in the given order) which it had
+    * not begun.  Resuming from the checkpoint reports exactly the cliques not yet reported.
+    */
+    class CliqueCheckpoint
+    {
+    public:
+        BranchOrdering ordering;
+        std::size_t numVertices;
+        std::size_t nextBranch;
+        std::vector<CliqueFrame> frames;
+
+        CliqueCheckpoint() :
+            ordering(BranchOrdering::None), numVertices(0), nextBranch(0) {}
+
+        bool isComplete() const
+        {
+            return frames.empty() && (nextBranch >= numVertices);
+        }
+
+        void save(std::ostream& out) const;
+        bool load(std::istream& in);
+    };
+
+    /**
+    * Counts of the search tree, level by level, as gathered by enumerators instrumented with a
+    * SearchStatsCollector (see BKSearch.hpp).  Level 0 holds the roots of the search, which are the
+    * top-level branches when they are ordered, and level d the calls made d levels below them.
+    */
+    struct SearchStatistics
+    {
+        struct Level
+        {
+            uint64_t calls = 0;
+            uint64_t sumCandidates = 0; /// the sum of |P| on entry
+            uint64_t maxCandidates = 0;
+            uint64_t sumExcluded = 0;   /// the sum of |X| on entry
+            uint64_t maxExcluded = 0;
+            uint64_t wordsScanned = 0;  /// 64-bit words read by countCommon and countCommonLimit while choosing pivots
+            uint64_t inPlace = 0;       /// vertices moved into S in place by the pivot rule of Naudé
+        };
+
+        std::vector<Level> levels;
+
+        Level& at(std::size_t level)
+        {
+            if (level >= levels.size()) levels.resize(level + 1);
+            return levels[level];
+        }
+
+        void clear()
+        {
+            levels.clear();
+        }
+
+        void accumulate(const SearchStatistics& other);
+
+        /// One row per level, with a header row.
+        void writeCSV(std::ostream& out) const;
+        /// An object holding an array of levels.
+        void writeJSON(std::ostream& out) const;
+    };
+
+    struct CliqueEnumerationOptions
+    {
+        BranchOrdering ordering;
+        unsigned numThreads; /// 0 selects the hardware concurrency
+
+        /**
+        * When set, each top-level branch is solved in a compact universe holding just the neighbours
+        * of its vertex, and no rows of n bits are built, so memory and the cost of each set operation
+        * follow the local degree rather than the size of the graph.  This suits large sparse graphs.
+        * BranchOrdering::None is taken to mean degeneracy order here.
+        */
+        bool localBranches;
+
+        /**
+        * Only maximal cliques with between minSize and maxSize vertices (inclusive) are reported.
+        * A branch is abandoned as soon as its clique together with all of its candidates is too small,
+        * or its clique has reached maxSize while candidates remain (any maximal clique there is too large).
+        * With colourBound set, a greedy colouring of the candidates gives a tighter bound for minSize.
+        * When minSize exceeds maxSize, no clique is reported.
+        */
+        std::size_t minSize;
+        std::size_t maxSize;
+        bool colourBound;
+
+        /**
+        * Enumeration stops early once cancellation is signalled, timeLimit seconds have passed, or
+        * about recursionLimit recursive calls have been made (zero means no limit).  These are
+        * checked once per thousand or so recursive calls.  The work left over is then written
+        * into checkpoint, if given; a run which finishes leaves it complete.  Passing a checkpoint
+        * as resume continues that earlier run, on the same graph, in place of a fresh start.
+        * The same checkpoint may be given for both.
+        */
+        CancellationToken* cancellation;
+        double timeLimit;
+        uint64_t recursionLimit;
+        CliqueCheckpoint* checkpoint;
+        const CliqueCheckpoint* resume;
+
+        /// The counts of an instrumented enumeration are added to statistics, if given.
+        /// Enumerators without instrumentation ignore it.
+        SearchStatistics* statistics;
+
+        CliqueEnumerationOptions() :
+            ordering(BranchOrdering::None), numThreads(1), localBranches(false),
+            minSize(0), maxSize(~(std::size_t)0), colourBound(false),
+            cancellation(nullptr), timeLimit(0.0), recursionLimit(0), checkpoint(nullptr), resume(nullptr),
+            statistics(nullptr) {}
+    };
+
     void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver);
 
     void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver);
 
+    /**
+    * Parallel variants.  The top-level branches of the search are shared out over numThreads
+    * worker threads (0 selects the hardware concurrency), and idle workers steal large
+    * sub-branches from busy ones.  See CliqueReceiver::fork for how cliques are delivered.
+    */
+    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver, unsigned numThreads);
+
+    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver, unsigned numThreads);
+
+    /**
+    * Configurable variants.  Parallel enumeration always works over ordered branches, so it takes
+    * BranchOrdering::None to mean index order.
+    */
+    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    /**
+    * The maximal independent sets of graph, reported as cliques are.  These are the maximal cliques of
+    * the complement, but no complement graph is built.  Local branches are not used here, as the
+    * complement of a sparse graph is dense.
+    */
+    void AllIndependentSets_Tomita(const Graph* graph, CliqueReceiver* receiver);
+
+    void AllIndependentSets_Naude(const Graph* graph, CliqueReceiver* receiver);
+
+    void AllIndependentSets_Tomita(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    void AllIndependentSets_Naude(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    /**
+    * Variants over a frozen graph, for callers who enumerate the same graph more than once.  The
+    * cliques are reported against graph.getGraph(), which must not have changed since it was frozen.
+    */
+    void AllCliques_Tomita(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    void AllCliques_Naude(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    void AllIndependentSets_Tomita(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    void AllIndependentSets_Naude(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options);
+
+    /**
+    * Finds a maximum clique by branch and bound, bounding each branch with a greedy colouring of
+    * its candidates.  The clique is written into clique and its size is returned.  If a receiver
+    * is given, each improvement of the incumbent is reported to it, so that the last clique
+    * reported is maximum, and its recursion count is the number of branches explored.
+    */
+    std::size_t MaximumClique(const Graph* graph, IntegerSet& clique, CliqueReceiver* receiver = nullptr);
+
 }
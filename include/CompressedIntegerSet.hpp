@@ -0,0 +1,186 @@
+
+#pragma once
+
+/**
+ * CompressedIntegerSet.hpp
+ * Purpose: To provide a non-negative integer set whose size follows its elements, not its universe.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+#include <BitStructures.hpp>
+
+namespace kn
+{
+
+    /**
+    * The CompressedIntegerSet holds the same sets as IntegerSet, after the manner of Roaring bitmaps.
+    * The universe is cut into chunks of ChunkSize values, and only the chunks holding elements are
+    * stored.  A chunk of at most ArrayLimit elements is a sorted array of 16-bit offsets; a fuller
+    * chunk is a bitmap of ChunkWords words.  Either way, a chunk needs at most 8 KB.  A set of ten
+    * elements in a universe of a million thus costs about 1 KB, even with each in a chunk of its
+    * own, rather than 125 KB, and isEmpty, count and firstElement take time in the number of
+    * chunks, not the universe.
+    *
+    * Operations between two compressed sets proceed chunk by chunk, by merging, probing or word
+    * loops, as the kinds of the two chunks suggest.  Operations with an IntegerSet read only the
+    * words of the bit vector which fall within stored chunks.
+    */
+    class CompressedIntegerSet
+    {
+    public:
+        static const std::size_t ChunkSize = 65536;
+        static const std::size_t ChunkWords = ChunkSize / 64;
+        static const std::size_t ArrayLimit = 4096;
+
+    private:
+        struct Chunk
+        {
+            std::size_t key;                /// the elements of the chunk, divided by ChunkSize
+            std::size_t cardinality;
+            std::vector<uint16_t> values;   /// the sorted offsets of an array chunk
+            std::vector<uint64_t> bits;     /// the ChunkWords words of a bitmap chunk
+
+            bool isBitmap() const
+            {
+                return !bits.empty();
+            }
+        };
+
+        struct ChunkOperations;     /// the operations on single chunks, in the source file
+
+    public:
+        /**
+        * The CompressedIntegerSet Iterator visits the elements in increasing order.  Unlike that of
+        * IntegerSet, it does not allow the set to be changed during the iteration.
+        */
+        struct Iterator
+        {
+        private:
+            friend class CompressedIntegerSet;
+
+            const Chunk* chunk;
+            const Chunk* end;
+
+            std::size_t position;   /// within the values of an array chunk, or the bits of a bitmap chunk
+            uint64_t currentBits;
+
+            Iterator(const Chunk* begin, const Chunk* end)
+            {
+                this->chunk = begin;
+                this->end = end;
+
+                position = 0;
+                currentBits = ((chunk != end) && chunk->isBitmap()) ? chunk->bits[0] : 0;
+            }
+
+        public:
+            bool hasNext()
+            {
+                while (chunk != end)
+                {
+                    if (chunk->isBitmap())
+                    {
+                        while ((currentBits == 0) && (position + 1 < ChunkWords))
+                        {
+                            position++;
+                            currentBits = chunk->bits[position];
+                        }
+                        if (currentBits != 0) return true;
+                    }
+                    else if (position < chunk->values.size())
+                    {
+                        return true;
+                    }
+
+                    chunk++;
+                    position = 0;
+                    currentBits = ((chunk != end) && chunk->isBitmap()) ? chunk->bits[0] : 0;
+                }
+                return false;
+            }
+
+            std::size_t next()
+            {
+                std::size_t base = chunk->key * ChunkSize;
+                if (chunk->isBitmap())
+                {
+                    uint64_t bit = lowestBit(currentBits);
+                    currentBits ^= bit;
+                    return base + position * 64 + bitToIndex(bit);
+                }
+                else
+                    return base + chunk->values[position++];
+            }
+        };
+
+    private:
+        std::size_t maxCardinality;
+        std::vector<Chunk> chunks;  /// in increasing order of key, and none of them empty
+
+        std::vector<Chunk>::iterator locate(std::size_t key);
+        std::vector<Chunk>::const_iterator locate(std::size_t key) const;
+
+    public:
+        CompressedIntegerSet();
+        CompressedIntegerSet(std::size_t maxCardinality);
+
+        Iterator iterator() const
+        {
+            return Iterator(chunks.data(), chunks.data() + chunks.size());
+        }
+
+        std::size_t getMaxCardinality() const
+        {
+            return maxCardinality;
+        }
+
+        void setMaxCardinality(std::size_t maxCardinality);
+
+        void add(std::size_t value);
+        void remove(std::size_t value);
+        bool contains(std::size_t value) const;
+
+        bool isEmpty() const
+        {
+            return chunks.empty();
+        }
+
+        std::size_t firstElement() const;
+        std::size_t lastElement() const;
+
+        void clear()
+        {
+            chunks.clear();
+        }
+
+        std::size_t count() const;
+        std::size_t countCommon(const CompressedIntegerSet& b) const;
+
+        void intersectWith(const CompressedIntegerSet& b);
+        void unionWith(const CompressedIntegerSet& b);
+
+        void removeAll(const CompressedIntegerSet& b);
+
+        void intersection(const CompressedIntegerSet& a, const CompressedIntegerSet& b);
+
+        /// The same operations against a dense IntegerSet of the same maximum cardinality.
+        std::size_t countCommon(const IntegerSet& b) const;
+        void intersectWith(const IntegerSet& b);
+        void removeAll(const IntegerSet& b);
+        void intersection(const CompressedIntegerSet& a, const IntegerSet& b);
+
+        /// Conversion to and from IntegerSet, which must have the same maximum cardinality.
+        void copy(const IntegerSet& b);
+        void copyTo(IntegerSet& b) const;
+
+        /// The bytes held by the set, including its chunks.
+        std::size_t memoryUsage() const;
+    };
+
+}
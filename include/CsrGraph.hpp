@@ -0,0 +1,207 @@
+
+#pragma once
+
+/**
+ * CsrGraph.hpp
+ * Purpose: An immutable snapshot of a Graph, in compressed sparse row form, for algorithms which only read it.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <BitStructures.hpp>
+#include <AttributeModel.hpp>
+#include <Graph.hpp>
+#include <Matrix.hpp>
+
+namespace kn
+{
+
+    /**
+    * The CsrGraph holds the arcs of a Graph in flat arrays, indexed by vertex index rather than by ID.
+    * The arcs leaving vertex u lie at positions outOffsets[u] up to outOffsets[u+1] of outTargets and
+    * outAttributes, sorted by the index of their destination.  The arcs entering v lie likewise in
+    * inSources and inAttributes, sorted by the index of their source.  An undirected edge appears as
+    * its two arcs, just as in the Graph.  A walk over the neighbours of a vertex is thus a scan of
+    * consecutive memory, and a test for an arc is a binary search, rather than a chase along a list.
+    *
+    * The snapshot does not follow later changes to the Graph.  It does keep a reference to the Graph,
+    * since clique receivers are handed the Graph itself, and so the Graph must outlive the snapshot.
+    */
+    class CsrGraph
+    {
+    public:
+        typedef Graph::VertexID VertexID;
+        typedef Graph::AttrID AttrID;
+
+        /// A read-only view of part of one of the arrays, such as the neighbour list of a vertex.
+        template <typename T>
+        class Range
+        {
+        private:
+            const T* first;
+            const T* last;
+
+        public:
+            Range(const T* first, const T* last)
+                : first(first), last(last)
+            {
+            }
+
+            const T* begin() const
+            {
+                return first;
+            }
+
+            const T* end() const
+            {
+                return last;
+            }
+
+            std::size_t size() const
+            {
+                return last - first;
+            }
+
+            const T& operator[](std::size_t index) const
+            {
+                return first[index];
+            }
+        };
+
+    private:
+        friend class GraphBuilder;
+
+        const Graph* graph;
+        const AttributeModel* vertexAttributeModel;
+        const AttributeModel* edgeAttributeModel;
+
+        std::size_t numVertices;
+        std::vector<VertexID> vertexIDs;
+        std::vector<AttrID> vertexAttributes;
+
+        std::vector<std::size_t> outOffsets;
+        std::vector<uint32_t> outTargets;
+        std::vector<AttrID> outAttributes;
+
+        std::vector<std::size_t> inOffsets;
+        std::vector<uint32_t> inSources;
+        std::vector<AttrID> inAttributes;
+
+        /// Takes the exiting lists as given, already sorted, from a GraphBuilder.
+        CsrGraph(const Graph& graph, std::vector<std::size_t>&& outOffsets, std::vector<uint32_t>&& outTargets, std::vector<AttrID>&& outAttributes);
+
+        void readVertices();
+        void transpose();
+
+    public:
+        explicit CsrGraph(const Graph& graph);
+
+        const Graph& getGraph() const
+        {
+            return *graph;
+        }
+
+        const AttributeModel* getVertexAttributeModel() const
+        {
+            return vertexAttributeModel;
+        }
+
+        const AttributeModel* getEdgeAttributeModel() const
+        {
+            return edgeAttributeModel;
+        }
+
+        std::size_t countVertices() const
+        {
+            return numVertices;
+        }
+
+        /// The number of arcs, in which an undirected edge counts twice, and an undirected loop once.
+        std::size_t countArcs() const
+        {
+            return outTargets.size();
+        }
+
+        VertexID getVertexID(std::size_t index) const
+        {
+            return vertexIDs[index];
+        }
+
+        AttrID getVertexAttribute(std::size_t index) const
+        {
+            return vertexAttributes[index];
+        }
+
+        std::size_t outDegree(std::size_t u) const
+        {
+            return outOffsets[u + 1] - outOffsets[u];
+        }
+
+        std::size_t inDegree(std::size_t v) const
+        {
+            return inOffsets[v + 1] - inOffsets[v];
+        }
+
+        Range<uint32_t> exitingTargets(std::size_t u) const
+        {
+            return Range<uint32_t>(outTargets.data() + outOffsets[u], outTargets.data() + outOffsets[u + 1]);
+        }
+
+        /// The attributes of the arcs leaving u, in the order of exitingTargets(u).
+        Range<AttrID> exitingAttributes(std::size_t u) const
+        {
+            return Range<AttrID>(outAttributes.data() + outOffsets[u], outAttributes.data() + outOffsets[u + 1]);
+        }
+
+        Range<uint32_t> enteringSources(std::size_t v) const
+        {
+            return Range<uint32_t>(inSources.data() + inOffsets[v], inSources.data() + inOffsets[v + 1]);
+        }
+
+        /// The attributes of the arcs entering v, in the order of enteringSources(v).
+        Range<AttrID> enteringAttributes(std::size_t v) const
+        {
+            return Range<AttrID>(inAttributes.data() + inOffsets[v], inAttributes.data() + inOffsets[v + 1]);
+        }
+
+        /// Tests for an arc from the vertex of index u to that of index v, searching the shorter list.
+        bool hasArc(std::size_t u, std::size_t v) const
+        {
+            if (outDegree(u) <= inDegree(v))
+            {
+                Range<uint32_t> targets = exitingTargets(u);
+                return std::binary_search(targets.begin(), targets.end(), (uint32_t)v);
+            }
+            else
+            {
+                Range<uint32_t> sources = enteringSources(v);
+                return std::binary_search(sources.begin(), sources.end(), (uint32_t)u);
+            }
+        }
+
+        /// As Graph::adjacency, but each row is had from one neighbour list.
+        std::unique_ptr<IntegerSetPool> adjacency(bool hugePages = false) const;
+
+        /// As Graph::constructAdjacencyMatrix, but in time proportional to the size of the matrix
+        /// and the number of arcs, rather than to their product.
+        template <typename T>
+        void constructAdjacencyMatrix(Matrix<T>& m) const
+        {
+            m.reshape(numVertices, numVertices);
+            m.fill(0);
+            for (std::size_t u = 0; u < numVertices; u++)
+            {
+                for (uint32_t v : exitingTargets(u))
+                {
+                    m.setValue(u, v, 1);
+                }
+            }
+        }
+    };
+
+}
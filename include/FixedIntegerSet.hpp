@@ -0,0 +1,407 @@
+
+#pragma once
+
+/**
+ * FixedIntegerSet.hpp
+ * Purpose: To provide an IntegerSet for small universes, whose words are held within the object.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cassert>
+#include <BitStructures.hpp>
+
+namespace kn
+{
+
+    /**
+    * The FixedIntegerSet has the interface of IntegerSet, over a universe of at most 64 * Words values.
+    * Its words are held within the object rather than on the heap, and every operation is a loop of
+    * exactly Words iterations, which the compiler unrolls.  A set is thus cheap to create and copy,
+    * and small ones live in registers or on the stack.  The maximum cardinality is still kept, as
+    * fill and invert must not stray past it.  Word counts of 1, 2 and 4 suit graphs of at most 64,
+    * 128 and 256 vertices; larger universes are better served by IntegerSet and its vector kernels.
+    */
+    template <std::size_t Words>
+    class FixedIntegerSet
+    {
+    public:
+        static const std::size_t Capacity = 64 * Words;
+
+        /**
+        * The Iterator behaves as that of IntegerSet: the set may be changed during the iteration, and
+        * the iterator will visit those elements after the current one which are present when reached.
+        */
+        struct Iterator
+        {
+        private:
+            friend class FixedIntegerSet;
+
+            const uint64_t* words;
+
+            std::size_t currentIndex;
+
+            std::size_t currentBaseValue;
+            uint64_t currentBits;
+            uint64_t currentMask;
+
+            Iterator(const uint64_t* words)
+            {
+                this->words = words;
+
+                currentIndex = 0;
+                currentBaseValue = 0;
+                currentBits = words[0];
+                currentMask = 0xFFFFFFFFFFFFFFFFULL;
+            }
+
+        public:
+            bool hasNext()
+            {
+                currentBits = words[currentIndex] & currentMask;
+                while ((currentBits == 0) && (currentIndex + 1 < Words))
+                {
+                    currentIndex++;
+                    currentBits = words[currentIndex];
+                    currentMask = 0xFFFFFFFFFFFFFFFFULL;
+                    currentBaseValue += 64;
+                }
+
+                return (currentBits != 0);
+            }
+
+            std::size_t next()
+            {
+                uint64_t bit = lowestBit(currentBits);
+                currentBits ^= bit;
+                currentMask = ~(bit - 1) - bit;
+                return currentBaseValue + bitToIndex(bit);
+            }
+        };
+
+    private:
+        std::size_t maxCardinality;
+        uint64_t words[Words];
+
+        /// The bits of word index which lie below maxCardinality.
+        uint64_t validBits(std::size_t index) const
+        {
+            std::size_t low = index * 64;
+            if (maxCardinality >= low + 64) return ~(uint64_t)0;
+            if (maxCardinality <= low) return 0;
+            return singleBit((int)(maxCardinality - low)) - 1;
+        }
+
+        void sanitiseHighBits()
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] &= validBits(index);
+            }
+        }
+
+    public:
+        FixedIntegerSet()
+            : maxCardinality(Capacity)
+        {
+            clear();
+        }
+
+        FixedIntegerSet(std::size_t maxCardinality)
+            : maxCardinality(maxCardinality)
+        {
+            assert(maxCardinality <= Capacity);
+            clear();
+        }
+
+        Iterator iterator() const
+        {
+            return Iterator(words);
+        }
+
+        std::size_t getMaxCardinality() const
+        {
+            return maxCardinality;
+        }
+
+        void setMaxCardinality(std::size_t maxCardinality)
+        {
+            assert(maxCardinality <= Capacity);
+            this->maxCardinality = maxCardinality;
+            sanitiseHighBits();
+        }
+
+        void add(std::size_t value)
+        {
+            assert(value < maxCardinality);
+            words[value / 64] |= singleBit(value % 64);
+        }
+
+        void remove(std::size_t value)
+        {
+            assert(value < maxCardinality);
+            words[value / 64] &= ~singleBit(value % 64);
+        }
+
+        bool contains(std::size_t value) const
+        {
+            if (value >= maxCardinality) return false;
+
+            return (0 != (words[value / 64] & singleBit(value % 64)));
+        }
+
+        bool isEmpty() const
+        {
+            uint64_t any = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                any |= words[index];
+            }
+            return any == 0;
+        }
+
+        std::size_t firstElement() const
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                if (words[index] != 0) return index * 64 + lowestBitIndex(words[index]);
+            }
+            return maxCardinality;
+        }
+
+        std::size_t lastElement() const
+        {
+            for (std::size_t index = Words; index > 0; index--)
+            {
+                if (words[index - 1] != 0) return (index - 1) * 64 + highestBitIndex(words[index - 1]);
+            }
+            return maxCardinality;
+        }
+
+        void clear()
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] = 0;
+            }
+        }
+
+        void fill()
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] = validBits(index);
+            }
+        }
+
+        void fillBefore(std::size_t value)
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                std::size_t low = index * 64;
+                if (value >= low + 64) words[index] = ~(uint64_t)0;
+                else if (value > low) words[index] |= singleBit((int)(value - low)) - 1;
+            }
+            sanitiseHighBits();
+        }
+
+        void fillAfter(std::size_t value)
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                std::size_t low = index * 64;
+                if (value < low) words[index] = ~(uint64_t)0;
+                else if (value < low + 64) words[index] |= ((~(uint64_t)0) << (value - low)) << 1;
+            }
+            sanitiseHighBits();
+        }
+
+        void copy(const FixedIntegerSet& b)
+        {
+            assert(maxCardinality == b.maxCardinality);
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] = b.words[index];
+            }
+        }
+
+        std::size_t count() const
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                sum += countBits(words[index]);
+            }
+            return sum;
+        }
+
+        std::size_t countLimit(std::size_t limit) const
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                sum += countBits(words[index]);
+                if (sum >= limit) break;
+            }
+            return sum;
+        }
+
+        std::size_t countCommon(const FixedIntegerSet& b) const
+        {
+            assert(maxCardinality == b.maxCardinality);
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                sum += countBits(words[index] & b.words[index]);
+            }
+            return sum;
+        }
+
+        /// As IntegerSet::countCommonLimit: the count stops once it reaches limit, and w is set to some
+        /// common element when the count is not zero.
+        std::size_t countCommonLimit(const FixedIntegerSet& b, std::size_t limit, std::size_t& w) const
+        {
+            assert(maxCardinality == b.maxCardinality);
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                uint64_t bits = words[index] & b.words[index];
+                if (bits != 0)
+                {
+                    sum += countBits(bits);
+                    w = index * 64 + lowestBitIndex(bits); /// any bit will do
+                    if (sum >= limit) break;
+                }
+            }
+            return sum;
+        }
+
+        /// As IntegerSet::commonWindow; every word is read.
+        void commonWindow(const FixedIntegerSet& b, std::size_t& low, std::size_t& high) const
+        {
+            low = 0;
+            high = Words;
+        }
+
+        std::size_t windowWords() const
+        {
+            return Words;
+        }
+
+        void invert()
+        {
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] = ~words[index] & validBits(index);
+            }
+        }
+
+        void intersectWith(const FixedIntegerSet& b)
+        {
+            assert(maxCardinality == b.maxCardinality);
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] &= b.words[index];
+            }
+        }
+
+        void unionWith(const FixedIntegerSet& b)
+        {
+            assert(maxCardinality == b.maxCardinality);
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] |= b.words[index];
+            }
+        }
+
+        void removeAll(const FixedIntegerSet& b)
+        {
+            assert(maxCardinality == b.maxCardinality);
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] &= ~b.words[index];
+            }
+        }
+
+        void intersection(const FixedIntegerSet& a, const FixedIntegerSet& b)
+        {
+            assert((maxCardinality == a.maxCardinality) && (maxCardinality == b.maxCardinality));
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                words[index] = a.words[index] & b.words[index];
+            }
+        }
+
+        std::size_t intersectionCount(const FixedIntegerSet& a, const FixedIntegerSet& b)
+        {
+            intersection(a, b);
+            return count();
+        }
+
+        bool intersectionAny(const FixedIntegerSet& a, const FixedIntegerSet& b)
+        {
+            intersection(a, b);
+            return !isEmpty();
+        }
+
+        bool intersectWithAny(const FixedIntegerSet& b)
+        {
+            intersectWith(b);
+            return !isEmpty();
+        }
+
+        /// As IntegerSet::countCommonBatch.  The rows are simply counted in turn, as each is a few words.
+        static const std::size_t CountCommonBatchSize = IntegerSet::CountCommonBatchSize;
+        void countCommonBatch(const FixedIntegerSet* const* rows, std::size_t numRows, std::size_t* counts) const
+        {
+            for (std::size_t r = 0; r < numRows; r++)
+            {
+                counts[r] = countCommon(*rows[r]);
+            }
+        }
+
+        /// As IntegerSet::decode, though no padding is needed.
+        std::size_t decode(uint32_t* out) const
+        {
+            std::size_t k = 0;
+            for (std::size_t index = 0; index < Words; index++)
+            {
+                uint64_t bits = words[index];
+                while (bits != 0)
+                {
+                    uint64_t bit = lowestBit(bits);
+                    bits ^= bit;
+                    out[k++] = (uint32_t)(index * 64 + bitToIndex(bit));
+                }
+            }
+            return k;
+        }
+
+        /// Conversion to and from IntegerSet, which must have the same maximum cardinality.
+        void copy(const IntegerSet& b)
+        {
+            assert(maxCardinality == b.getMaxCardinality());
+            clear();
+            auto it = b.iterator();
+            while (it.hasNext())
+            {
+                add(it.next());
+            }
+        }
+
+        void copyTo(IntegerSet& b) const
+        {
+            assert(maxCardinality == b.getMaxCardinality());
+            b.clear();
+            auto it = iterator();
+            while (it.hasNext())
+            {
+                b.add(it.next());
+            }
+        }
+    };
+
+}
@@ -23,6 +23,9 @@
 namespace kn
 {
 
+    class CsrGraph;
+    class GraphBuilder;
+
     class Graph
     {
     public:
@@ -65,6 +68,25 @@ namespace kn
         class EdgeIterator;
         class Walker;
 
+        /**
+        * The index by which hasArc is answered; see setArcIndex.  None scans the shorter of the two
+        * edge lists.  Dense keeps an IntegerSet row of arc destinations for each vertex, which costs
+        * n^2 bits.  Sparse keeps a hash table over the pairs joined by arcs, which costs space in
+        * proportion to the number of arcs.  Automatic takes Dense where the rows would be no larger
+        * than the hash table, and Sparse elsewhere.  The choice is made again whenever dense rows are
+        * outgrown by added vertices, and a sparse index turns dense once arcs are added to the point
+        * where the rows would be no larger.  Dense rows are given room for twice the vertices, and
+        * are given up only when they would be four times the size that admits them, so that a graph
+        * growing near the threshold does not switch back and forth.
+        */
+        enum class ArcIndex
+        {
+            None,
+            Dense,
+            Sparse,
+            Automatic
+        };
+
     private:
         struct EdgeInfo : Edge
         {
@@ -81,34 +103,169 @@ namespace kn
             EdgeInfo* sourceEdges;
         };
 
+        /**
+        * The EdgeArena hands out EdgeInfo nodes from slabs owned by the Graph.  A node is taken by
+        * bumping a counter within the last slab, or from the list of nodes given back, which are chained
+        * through nextFromSource.  Nodes are never returned to the heap one at a time: the slabs are
+        * released together when the Graph is cleared or destroyed.  The slabs grow geometrically, so
+        * that a graph of m arcs costs O(log m) allocations in all.
+        */
+        class EdgeArena
+        {
+        private:
+            static const std::size_t FirstSlabSize = 64;
+            static const std::size_t MaxSlabSize = 65536;
+
+            std::vector<std::unique_ptr<EdgeInfo[]>> slabs;
+            std::size_t slabSize; /// the capacity of the last slab
+            std::size_t used;     /// the nodes taken from the last slab
+            EdgeInfo* freeList;
+
+            void grow();
+
+        public:
+            EdgeArena()
+                : slabSize(0), used(0), freeList(nullptr)
+            {
+            }
+
+            EdgeInfo* allocate()
+            {
+                if (freeList)
+                {
+                    EdgeInfo* e = freeList;
+                    freeList = e->nextFromSource;
+                    return e;
+                }
+                if (used == slabSize) grow();
+                return &slabs.back()[used++];
+            }
+
+            /// Ensures that the next count nodes are taken without further allocation.  What remains
+            /// of the last slab is given back through the free list.
+            void reserve(std::size_t count)
+            {
+                if (slabSize - used >= count) return;
+                while (used < slabSize)
+                {
+                    release(&slabs.back()[used++]);
+                }
+                slabs.emplace_back(new EdgeInfo[count]);
+                slabSize = count;
+                used = 0;
+            }
+
+            void release(EdgeInfo* e)
+            {
+                e->nextFromSource = freeList;
+                freeList = e;
+            }
+
+            void clear()
+            {
+                slabs.clear();
+                slabSize = 0;
+                used = 0;
+                freeList = nullptr;
+            }
+
+            void swap(EdgeArena& other)
+            {
+                slabs.swap(other.slabs);
+                std::swap(slabSize, other.slabSize);
+                std::swap(used, other.used);
+                std::swap(freeList, other.freeList);
+            }
+        };
+
     private:
+        friend class GraphBuilder;
+
         const AttributeModel* vertexAttributes;
         const AttributeModel* edgeAttributes;
 
         std::vector<VertexInfo> vertices;
         std::unordered_map<VertexID, std::size_t> vertexIDtoIndex;
         std::unordered_map<EdgeID, VertexID> edgeIDtoSourceID;
+        EdgeArena edges;
 
         VertexID nextVertexID;
         EdgeID nextEdgeID;
 
-        void deleteEdge(EdgeInfo* e);
+        struct PairHash
+        {
+            std::size_t operator()(const Pair& p) const
+            {
+                return (std::size_t)(p.u * 0x9E3779B97F4A7C15ULL) ^ p.v;
+            }
+        };
+
+        struct PairEqual
+        {
+            bool operator()(const Pair& a, const Pair& b) const
+            {
+                return (a.u == b.u) && (a.v == b.v);
+            }
+        };
+
+        /// The index as requested, and whether it is presently held as rows or as a hash table.
+        ArcIndex arcIndex = ArcIndex::None;
+        bool denseArcIndex = false;
+
+        /// Dense: row ui holds vi for every arc from the vertex of index ui to that of index vi.
+        /// There is room for more rows than vertices, so that most additions need no rebuild.
+        IntegerSetPool arcRows;
+
+        /// Sparse: the number of arcs joining each pair of vertex IDs, as parallel arcs are permitted.
+        std::unordered_map<Pair, std::size_t, PairHash, PairEqual> arcCounts;
+
+        bool preferDenseArcIndex(std::size_t capacity, std::size_t numArcs) const;
+        void rebuildArcIndex(std::size_t capacity);
+        void indexArc(std::size_t fromIndex, std::size_t toIndex, VertexID sourceID, VertexID destinationID);
+        void unindexArc(std::size_t fromIndex, std::size_t toIndex, VertexID sourceID, VertexID destinationID);
+
+        void deleteEdge(EdgeInfo* e, bool unindex = true);
         void removeEdgeHelper(VertexID sourceID, VertexID destinationID);
 
         void insertEdge(EdgeID id, VertexID sourceID, VertexID destinationID, AttrID attrID, bool undirected);
+        void insertEdgeByIndices(EdgeID id, std::size_t fromIndex, std::size_t toIndex, AttrID attrID, bool undirected);
+        EdgeID addEdgeByIndices(std::size_t fromIndex, std::size_t toIndex, AttrID attrID, bool undirected);
+
+        void copyFrom(const Graph& other);
+        void copyPermuted(const Graph& other, const std::vector<VertexID>& permutation, bool reassignAttributes);
+        void copyComplement(const Graph& other);
+
+        void vertexAdjacency(VertexID id, IntegerSet& row) const;
 
-        void vertexAdjacency(VertexID id, IntegerSet& row);
+        /// The index of each vertex, looked up by ID in a table of nextVertexID entries, so that a pass
+        /// over all of the arcs may find their end points without hashing.
+        std::vector<std::size_t> indicesByID() const
+        {
+            std::vector<std::size_t> indices(nextVertexID, 0);
+            for (std::size_t index = 0; index < vertices.size(); index++)
+            {
+                indices[vertices[index].id] = index;
+            }
+            return indices;
+        }
 
     public:
         Graph();
         Graph(const AttributeModel* vertexAttributeModel, const AttributeModel* edgeAttributeModel);
 
+        /// A copy keeps the vertex and edge IDs of other, its attribute models and its arc index,
+        /// and is made in one pass over the edge lists.
         Graph(const Graph& other) : Graph(other, false)
         {
         }
 
+        /// The complement has an undirected edge wherever other has no arc either way, and an arc
+        /// opposing each arc of other which is not matched by one in reverse.  Its vertices are
+        /// numbered afresh, in the order of their indices in other.
         Graph(const Graph& other, bool complement);
 
+        /// Vertex k is the vertex of index permutation[k] in other, and takes its attribute, or
+        /// permutation[k] + 1 if reassignAttributes is set.  The vertices are numbered afresh.
         Graph(const Graph& other, const std::vector<VertexID>& permutation, bool reassignAttributes = false);
 
         virtual ~Graph();
@@ -122,11 +279,24 @@ namespace kn
             vertices.clear();
             vertexIDtoIndex.clear();
             edgeIDtoSourceID.clear();
+            edges.clear();
+            if (arcIndex != ArcIndex::None) rebuildArcIndex(0);
 
             nextVertexID = 0;
             nextEdgeID = 0;
         }
 
+        /// Selects the index by which hasArc and hasEdge are answered.  The index is built at once,
+        /// and thereafter kept up to date by every change to the graph, so that hasArc takes constant
+        /// expected time.  Removing a vertex from a dense index clears its row and column, and then
+        /// shifts the later rows and columns down, as the vertex indices shift.
+        void setArcIndex(ArcIndex index);
+
+        ArcIndex getArcIndex() const
+        {
+            return arcIndex;
+        }
+
         const AttributeModel* getVertexAttributeModel() const
         {
             return vertexAttributes;
@@ -137,31 +307,36 @@ namespace kn
             return edgeAttributes;
         }
 
-        std::unique_ptr<IntegerSet> vertexAdjacency(VertexID id)
+        /// The indices of the vertices to which id has arcs, read from its exiting edges.
+        std::unique_ptr<IntegerSet> vertexAdjacency(VertexID id) const
         {
             std::unique_ptr<IntegerSet> adj(new IntegerSet(vertices.size()));
             vertexAdjacency(id, *adj);
             return adj;
         }
 
-        std::unique_ptr<std::vector<IntegerSet>> adjacency();
+        /// Row u holds the index of every vertex to which the vertex of index u has an arc.  Each row is
+        /// filled from the exiting edges of its vertex, so that the cost is that of clearing the rows
+        /// and walking the arcs once.  Rows lie on separate cache lines, and so a large graph may have
+        /// its rows filled by numThreads threads at once (0 selects the hardware concurrency).
+        std::unique_ptr<IntegerSetPool> adjacency(bool hugePages = false, unsigned numThreads = 1) const;
+
+        /// An immutable snapshot of this graph in compressed sparse row form; see CsrGraph.hpp.
+        CsrGraph freeze() const;
 
+        /// Sets m[u][v] to 1 where the vertex of index u has an arc to that of index v, and to 0 elsewhere.
+        /// The matrix is zeroed in one pass, and then each arc sets its own element.
         template <typename T>
         void constructAdjacencyMatrix(Matrix<T>& m) const
         {
             m.reshape(vertices.size(), vertices.size());
+            m.fill(0);
+            std::vector<std::size_t> indices = indicesByID();
             for (std::size_t u = 0; u < vertices.size(); u++)
             {
-                for (std::size_t v = 0; v < vertices.size(); v++)
+                for (const EdgeInfo* e = vertices[u].sourceEdges; e; e = e->nextFromSource)
                 {
-                    if (hasArc(vertices[u].id, vertices[v].id))
-                    {
-                        m.setValue(u, v, 1);
-                    }
-                    else
-                    {
-                        m.setValue(u, v, 0);
-                    }
+                    m.setValue(u, indices[e->v], 1);
                 }
             }
         }
@@ -269,6 +444,7 @@ namespace kn
             vertices.push_back(v);
 
             vertexIDtoIndex.insert(std::make_pair(id, index));
+            if (denseArcIndex && (vertices.size() > arcRows.size())) rebuildArcIndex(2 * vertices.size());
 
             return id;
         }
@@ -291,6 +467,10 @@ namespace kn
         bool hasEdge(VertexID sourceID, VertexID destinationID) const;
         bool hasEdgeByIndices(std::size_t sourceIndex, std::size_t destinationIndex) const;
 
+        /// Answers hasArc for each pair in turn.  Without an index, the pairs are grouped by source,
+        /// so that the exiting edges of each source are walked only once.
+        std::vector<bool> hasArcs(const std::vector<Pair>& pairs) const;
+
         EdgeID addArc(VertexID sourceID, VertexID destinationID, AttrID attrID)
         {
             if (!validVertexID(sourceID) || !validVertexID(destinationID))
@@ -329,95 +509,15 @@ namespace kn
             }
         }
 
-        std::vector<VertexID> listOfVertices()
-        {
-            std::vector<VertexID> result(vertices.size());
-            for (auto it = vertices.begin(); it != vertices.end(); ++it)
-            {
-                result.push_back(it->id);
-            }
-            return result;
-        }
-
-        std::vector<Pair> listOfEdges()
-        {
-            std::vector<Pair> result(countEdges());
-            for (std::size_t ui = 0; ui < vertices.size(); ui++)
-            {
-                VertexID u = vertices[ui].id;
-
-                for (std::size_t vi = 0; vi < vertices.size(); vi++)
-                {
-                    VertexID v = vertices[vi].id;
-
-                    if ((u <= v) && hasEdge(u, v))
-                    {
-                        result.push_back(Pair(u, v));
-                    }
-                }
-            }
-            return result;
-        }
-
-        std::vector<Pair> listOfArcs()
-        {
-            std::vector<Pair> result(countEdges());
-            for (std::size_t ui = 0; ui < vertices.size(); ui++)
-            {
-                VertexID u = vertices[ui].id;
-
-                for (std::size_t vi = 0; vi < vertices.size(); vi++)
-                {
-                    VertexID v = vertices[vi].id;
+        std::vector<VertexID> listOfVertices() const;
 
-                    if (hasArc(u, v))
-                    {
-                        result.push_back(Pair(u, v));
-                    }
-                }
-            }
-            return result;
-        }
-
-        std::vector<Pair> listOfAbsentEdges()
-        {
-            std::vector<Pair> result(countEdges());
-            for (std::size_t ui = 0; ui < vertices.size(); ui++)
-            {
-                VertexID u = vertices[ui].id;
-
-                for (std::size_t vi = 0; vi < vertices.size(); vi++)
-                {
-                    VertexID v = vertices[vi].id;
-
-                    if ((u < v) && !hasArc(u, v) && !hasArc(v, u))
-                    {
-                        result.push_back(Pair(u, v));
-                    }
-                }
-            }
-            return result;
-        }
-
-        std::vector<Pair> listOfAbsentArcs()
-        {
-            std::vector<Pair> result(countEdges());
-            for (std::size_t ui = 0; ui < vertices.size(); ui++)
-            {
-                VertexID u = vertices[ui].id;
-
-                for (std::size_t vi = 0; vi < vertices.size(); vi++)
-                {
-                    VertexID v = vertices[vi].id;
-
-                    if ((u != v) && !hasArc(u, v))
-                    {
-                        result.push_back(Pair(u, v));
-                    }
-                }
-            }
-            return result;
-        }
+        /// The lists below are ordered by the index of u, and then by that of v, and name each pair
+        /// once, however many parallel arcs join it.  The present pairs are read from the edge lists;
+        /// the absent pairs are the complement of the neighbours of each u, marked in a bit set.
+        std::vector<Pair> listOfEdges() const;
+        std::vector<Pair> listOfArcs() const;
+        std::vector<Pair> listOfAbsentEdges() const;
+        std::vector<Pair> listOfAbsentArcs() const;
 
     public:
 
@@ -0,0 +1,112 @@
+
+#pragma once
+
+/**
+ * GraphBuilder.hpp
+ * Purpose: Build a Graph, and optionally its CsrGraph, from lists of vertices and edges gathered in bulk.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <Graph.hpp>
+#include <CsrGraph.hpp>
+
+namespace kn
+{
+
+    /**
+    * The GraphBuilder gathers vertices, edges and arcs into flat arrays, and then adds them to a Graph
+    * all at once.  Duplicate edges are merged without any lookups in the Graph: the edges are sorted,
+    * over several threads when there are many, and the first of each run of duplicates is kept, as a
+    * loader which tested hasEdge before each addEdge would have done.  Arcs are kept as given, since
+    * a Graph may hold parallel arcs.  The Graph is then sized exactly before anything is inserted.
+    *
+    * Vertices are named by the order in which they were added to the builder, from 0.  Edges and arcs
+    * whose end points were never added are skipped, just as Graph::addEdge ignores unknown IDs.
+    */
+    class GraphBuilder
+    {
+    public:
+        typedef Graph::AttrID AttrID;
+
+    private:
+        struct Entry
+        {
+            std::size_t u;
+            std::size_t v;
+            AttrID attrID;
+            std::size_t order; /// the number of entries added before this one
+        };
+
+        std::vector<AttrID> vertexAttributes;
+        std::vector<Entry> edges;
+        std::vector<Entry> arcs;
+
+        void mergeEdges();
+        void insertInto(Graph& g);
+
+    public:
+        void reserve(std::size_t numVertices, std::size_t numEdges)
+        {
+            vertexAttributes.reserve(numVertices);
+            edges.reserve(numEdges);
+        }
+
+        void clear()
+        {
+            vertexAttributes.clear();
+            edges.clear();
+            arcs.clear();
+        }
+
+        std::size_t countVertices() const
+        {
+            return vertexAttributes.size();
+        }
+
+        std::size_t addVertex(AttrID attrID)
+        {
+            vertexAttributes.push_back(attrID);
+            return vertexAttributes.size() - 1;
+        }
+
+        /// Adds vertices with attribute 0 until index names a vertex.
+        void ensureVertex(std::size_t index)
+        {
+            if (index >= vertexAttributes.size()) vertexAttributes.resize(index + 1, 0);
+        }
+
+        void addEdge(std::size_t u, std::size_t v, AttrID attrID)
+        {
+            if (u > v) std::swap(u, v);
+            Entry e = { u, v, attrID, edges.size() + arcs.size() };
+            edges.push_back(e);
+        }
+
+        void addArc(std::size_t u, std::size_t v, AttrID attrID)
+        {
+            Entry e = { u, v, attrID, edges.size() + arcs.size() };
+            arcs.push_back(e);
+        }
+
+        /// Adds the vertices and edges to g, after any it already holds, and leaves the builder empty.
+        /// The edge IDs follow the order of the end points rather than the order in which edges were added.
+        void build(Graph& g);
+
+        Graph* build(const AttributeModel* vertexAttributeModel = nullptr, const AttributeModel* edgeAttributeModel = nullptr)
+        {
+            Graph* g = new Graph(vertexAttributeModel, edgeAttributeModel);
+            build(*g);
+            return g;
+        }
+
+        /// As build, but also returns the snapshot of g, whose lists are had from the sorted edges
+        /// rather than from the edge lists of g.  If g was not empty, g is simply frozen afterwards.
+        CsrGraph buildFrozen(Graph& g);
+    };
+
+}
@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <Graph.hpp>
+#include <CsrGraph.hpp>
 #include <Matrix.hpp>
 #include <AssignmentSolver.hpp>
 
@@ -25,11 +26,11 @@ namespace kn
         int index, concludedIndex;
 
     protected:
-        virtual void doInit(Matrix<float>& newSim, const Graph& a, const Graph& b);
+        virtual void doInit(Matrix<float>& newSim, const CsrGraph& a, const CsrGraph& b);
 
         virtual void doStep(Matrix<float>& newSim, const Matrix<float>& sim) = 0;
 
-        virtual bool doPostprocess(const Graph& a, const Graph& b, Matrix<float>& newSim, const Matrix<float>& sim);
+        virtual bool doPostprocess(const CsrGraph& a, const CsrGraph& b, Matrix<float>& newSim, const Matrix<float>& sim);
 
     public:
         FixedPointSimilarity()
@@ -42,8 +43,11 @@ namespace kn
             assignmentSolver = std::move(solver);
         }
 
+        /// The graphs are frozen first, as the similarity reads their vertices and arcs many times over.
         void solve(Matching<float>& mapping, const Graph& a, const Graph& b, double threshold);
 
+        void solve(Matching<float>& mapping, const CsrGraph& a, const CsrGraph& b, double threshold);
+
         void setAssignmentSolver(std::unique_ptr<AssignmentSolver<float>> solver)
         {
             assignmentSolver = std::move(solver);
@@ -69,7 +73,7 @@ namespace kn
         bool odd;
 
     protected:
-        virtual void doInit(Matrix<float>& newSim, const Graph& a, const Graph& b);
+        virtual void doInit(Matrix<float>& newSim, const CsrGraph& a, const CsrGraph& b);
 
         virtual void doStep(Matrix<float>& newSim, const Matrix<float>& sim);
 
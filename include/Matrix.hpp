@@ -13,6 +13,7 @@
 #include <memory>
 #include <stdexcept>
 #include <cassert>
+#include <cmath>
 #include <ArrayView.hpp>
 
 namespace kn
@@ -208,6 +209,12 @@ namespace kn
             values[(row << rowShift) + (column << columnShift)] = value;
         }
 
+        /// Sets every element to value in one pass over the storage, whatever its layout.
+        void fill(T value)
+        {
+            std::fill(values, values + size, value);
+        }
+
 
         void columnsFromVector(const Matrix<T>& m, std::size_t rows)
         {
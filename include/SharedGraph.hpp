@@ -0,0 +1,118 @@
+
+#pragma once
+
+/**
+ * SharedGraph.hpp
+ * Purpose: A copy-on-write handle to a Graph, so that one loaded graph may serve many readers.
+ *
+ * @author Kevin A. Naudé
+ * @version 1.1
+ */
+
+#include <memory>
+#include <Graph.hpp>
+
+namespace kn
+{
+
+    /**
+    * Copies of a SharedGraph refer to one Graph, and so cost no more than a reference count.  The
+    * Graph is read through get(), operator* and operator->.  The first call to modify() on a handle
+    * whose Graph is shared gives that handle a copy of its own, which keeps the vertex and edge IDs,
+    * so that the other handles never see the change.  A harness may thus load a graph once and hand
+    * each run a clone, paying for a copy only when a run alters its graph.
+    *
+    * Once modify() has handed out a reference, the handle is private: the reference may still be
+    * written through, and so clone() and copies of the handle take a deep copy rather than share.
+    * Calling share() declares that the reference is no longer used, and lets clones share again.
+    *
+    * Handles may be read from several threads at once.  A handle must not be modified while it is
+    * being cloned, just as a Graph must not be changed while it is being read.
+    */
+    class SharedGraph
+    {
+    private:
+        std::shared_ptr<Graph> graph;
+        bool modifiable; /// whether modify() has handed out a reference since the last share()
+
+    public:
+        SharedGraph()
+            : graph(std::make_shared<Graph>()), modifiable(false)
+        {
+        }
+
+        /// Takes ownership of g, as returned by the loaders and generators.
+        explicit SharedGraph(Graph* g)
+            : graph(g), modifiable(false)
+        {
+        }
+
+        explicit SharedGraph(Graph&& g)
+            : graph(std::make_shared<Graph>(std::move(g))), modifiable(false)
+        {
+        }
+
+        SharedGraph(const SharedGraph& other)
+            : graph(other.modifiable ? std::make_shared<Graph>(*other.graph) : other.graph), modifiable(false)
+        {
+        }
+
+        SharedGraph(SharedGraph&& other) = default;
+
+        SharedGraph& operator=(const SharedGraph& other)
+        {
+            if (this != &other)
+            {
+                graph = other.modifiable ? std::make_shared<Graph>(*other.graph) : other.graph;
+                modifiable = false;
+            }
+            return *this;
+        }
+
+        SharedGraph& operator=(SharedGraph&& other) = default;
+
+        SharedGraph clone() const
+        {
+            return *this;
+        }
+
+        bool isShared() const
+        {
+            return graph.use_count() > 1;
+        }
+
+        /// Declares that the reference returned by modify() is no longer written through.
+        void share()
+        {
+            modifiable = false;
+        }
+
+        const Graph* get() const
+        {
+            return graph.get();
+        }
+
+        const Graph& operator*() const
+        {
+            return *graph;
+        }
+
+        const Graph* operator->() const
+        {
+            return graph.get();
+        }
+
+        /// The Graph of this handle alone, copied first if another handle shares it.  The handle
+        /// stays private until share() is called.
+        Graph& modify()
+        {
+            if (graph.use_count() > 1)
+            {
+                graph = std::make_shared<Graph>(*graph);
+            }
+            modifiable = true;
+            return *graph;
+        }
+    };
+
+}
@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
 #include <string>
 #include <string.h>
 #include <time.h>
@@ -16,7 +17,9 @@
 #include <sstream>
 #include <BitStructures.hpp>
 #include <Graph.hpp>
+#include <SharedGraph.hpp>
 #include <CliqueEnumeration.hpp>
+#include <BKSearch.hpp>
 #include <StopWatch.hpp>
 #include <GraphLoader.hpp>
 #include <MersenneTwister.hpp>
@@ -31,6 +34,11 @@ typedef PrettyPrintCliqueReceiver TheCliqueReceiver;
 #endif
 
 typedef void(*CliqueEnumerator)(const Graph* g, CliqueReceiver* cr);
+typedef void(*ConfiguredCliqueEnumerator)(const Graph* g, CliqueReceiver* cr, const CliqueEnumerationOptions& options);
+
+/// The benchmarked methods, which are all given a CountingCliqueReceiver.
+typedef void(*CountingCliqueEnumerator)(const Graph* g, CountingCliqueReceiver* cr);
+typedef void(*ConfiguredCountingCliqueEnumerator)(const Graph* g, CountingCliqueReceiver* cr, const CliqueEnumerationOptions& options);
 
 void test(CliqueEnumerator ce, const Graph& graph)
 {
@@ -132,16 +140,84 @@ std::vector<SyntheticBenchmark> SyntheticBenchmarks = {
     SyntheticBenchmark{ 10000, 0.03, 2 }
 };
 
+/// AllCliques_Tomita and AllCliques_Naude, which accept any receiver.
+
+template <CliqueEnumerator Enumerate>
+void GeneralCliques(const Graph* g, CountingCliqueReceiver* cr)
+{
+    Enumerate(g, cr);
+}
+
+template <ConfiguredCliqueEnumerator Enumerate>
+void GeneralCliquesConfigured(const Graph* g, CountingCliqueReceiver* cr, const CliqueEnumerationOptions& options)
+{
+    Enumerate(g, cr, options);
+}
+
+/// The searches behind AllCliques_Tomita and AllCliques_Naude, specialised at compile time for
+/// the receiver used by these benchmarks, so that no call in the recursion is virtual.
+
+template <typename PivotPolicy>
+void StaticCliques(const Graph* g, CountingCliqueReceiver* cr)
+{
+    AllCliques<PivotPolicy>(g, cr);
+}
+
+template <typename PivotPolicy>
+void StaticCliquesConfigured(const Graph* g, CountingCliqueReceiver* cr, const CliqueEnumerationOptions& options)
+{
+    AllCliques<PivotPolicy>(g, cr, options);
+}
+
+/// Instrumented searches, which gather counts of the search tree into Statistics.
+/// These are written out after each benchmark, in the format chosen by the stats= option.
+
+SearchStatistics Statistics;
+std::string StatisticsFormat = "csv";
+
+template <typename PivotPolicy>
+void InstrumentedCliquesConfigured(const Graph* g, CountingCliqueReceiver* cr, const CliqueEnumerationOptions& options)
+{
+    CliqueEnumerationOptions instrumented = options;
+    instrumented.statistics = &Statistics;
+    AllCliques<PivotPolicy, CountingCliqueReceiver, SearchStatsCollector>(g, cr, instrumented);
+}
+
+template <typename PivotPolicy>
+void InstrumentedCliques(const Graph* g, CountingCliqueReceiver* cr)
+{
+    InstrumentedCliquesConfigured<PivotPolicy>(g, cr, CliqueEnumerationOptions());
+}
+
+/// Writes the statistics gathered for a benchmark to handle_benchmark.csv (or .json), and clears them.
+void saveStatistics(const std::string& handle, const std::string& benchmark)
+{
+    if (Statistics.levels.empty()) return;
+
+    std::string filename = handle + "_" + benchmark + "." + StatisticsFormat;
+    std::ofstream out(filename.c_str());
+    if (StatisticsFormat == "json")
+        Statistics.writeJSON(out);
+    else
+        Statistics.writeCSV(out);
+    Statistics.clear();
+}
+
 struct CliqueEnumerationMethod
 {
     std::string handle;
     std::string name;
-    CliqueEnumerator enumerator;
+    CountingCliqueEnumerator enumerator;
+    ConfiguredCountingCliqueEnumerator configuredEnumerator;
 };
 
 std::vector<CliqueEnumerationMethod> Methods = {
-    CliqueEnumerationMethod{ "tomita-et-al", "Tomita et al.", &AllCliques_Tomita },
-    CliqueEnumerationMethod{ "naude", "Naude", &AllCliques_Naude }
+    CliqueEnumerationMethod{ "tomita-et-al", "Tomita et al.", &GeneralCliques<&AllCliques_Tomita>, &GeneralCliquesConfigured<&AllCliques_Tomita> },
+    CliqueEnumerationMethod{ "naude", "Naude", &GeneralCliques<&AllCliques_Naude>, &GeneralCliquesConfigured<&AllCliques_Naude> },
+    CliqueEnumerationMethod{ "tomita-static", "Tomita et al. (static)", &StaticCliques<TomitaPivot>, &StaticCliquesConfigured<TomitaPivot> },
+    CliqueEnumerationMethod{ "naude-static", "Naude (static)", &StaticCliques<NaudePivot>, &StaticCliquesConfigured<NaudePivot> },
+    CliqueEnumerationMethod{ "tomita-stats", "Tomita et al. (instrumented)", &InstrumentedCliques<TomitaPivot>, &InstrumentedCliquesConfigured<TomitaPivot> },
+    CliqueEnumerationMethod{ "naude-stats", "Naude (instrumented)", &InstrumentedCliques<NaudePivot>, &InstrumentedCliquesConfigured<NaudePivot> }
 };
 
 std::string formatDouble(double v, int places)
@@ -182,11 +258,117 @@ std::string formatText(std::string name, int width)
 }
 
 
+/// Reads a clique size, which must be a plain decimal number.
+bool parseSize(const char* text, std::size_t& size)
+{
+    if (*text == 0) return false;
+    std::size_t value = 0;
+    for (; *text != 0; text++)
+    {
+        if ((*text < '0') || (*text > '9')) return false;
+        value = 10 * value + (std::size_t)(*text - '0');
+    }
+    size = value;
+    return true;
+}
+
+bool parseOption(const std::string& option, CliqueEnumerationOptions& options)
+{
+    if (option.compare(0, 8, "threads=") == 0)
+        options.numThreads = (unsigned)atoi(option.c_str() + 8);
+    else
+    if (option == "order=none")
+        options.ordering = BranchOrdering::None;
+    else
+    if (option == "order=index")
+        options.ordering = BranchOrdering::Index;
+    else
+    if (option == "order=degeneracy")
+        options.ordering = BranchOrdering::Degeneracy;
+    else
+    if (option == "local")
+        options.localBranches = true;
+    else
+    if (option.compare(0, 4, "min=") == 0)
+        return parseSize(option.c_str() + 4, options.minSize);
+    else
+    if (option.compare(0, 4, "max=") == 0)
+        return parseSize(option.c_str() + 4, options.maxSize);
+    else
+    if (option == "colour")
+        options.colourBound = true;
+    else
+        return false;
+    return true;
+}
+
+void benchmarkMaximumClique(int level)
+{
+    std::cout << "benchmark, omega, num_branches, seconds" << std::endl;
+    for (std::size_t t = 0; t < FixedBenchmarks.size(); t++)
+    {
+        if (FixedBenchmarks[t].level <= level)
+        {
+            GraphLoader loader(selectPathTo(FixedBenchmarks[t].filename));
+
+            if (loader.isOpen())
+            {
+                Graph* g = loader.loadDIMACSB();
+
+                IntegerSet clique;
+                CountingCliqueReceiver cr;
+                StopWatch sw;
+
+                sw.start();
+                std::size_t omega = MaximumClique(g, clique, &cr);
+                sw.stop();
+
+                double seconds = sw.elapsedSeconds();
+                std::cout << FixedBenchmarks[t].name << ", " << omega << ", " << cr.recursionCount() << ", " << formatDouble(seconds, 5) << std::endl;
+
+                delete g;
+            }
+        }
+    }
+
+    uint32_t seed = 1234567;
+    MersenneTwister random(seed);
+    for (std::size_t t = 0; t < SyntheticBenchmarks.size(); t++)
+    {
+        if (SyntheticBenchmarks[t].level <= level)
+        {
+            const int N = 10;
+            uint64_t sumOmega = 0;
+            uint64_t numBranches = 0;
+            double numSeconds = 0.0;
+            for (int k = 0; k < N; k++)
+            {
+                Graph* g = ErdosRenyi::Gnp(random, SyntheticBenchmarks[t].n, SyntheticBenchmarks[t].p, nullptr, nullptr);
+
+                IntegerSet clique;
+                CountingCliqueReceiver cr;
+                StopWatch sw;
+
+                sw.start();
+                sumOmega += MaximumClique(g, clique, &cr);
+                sw.stop();
+
+                numBranches += cr.recursionCount();
+                numSeconds += sw.elapsedSeconds();
+
+                delete g;
+            }
+
+            std::cout << "Gnp(n=" << SyntheticBenchmarks[t].n << "; p=" << formatDouble(SyntheticBenchmarks[t].p, 3) << "), " << formatDouble((double)sumOmega / N, 1) << ", " << numBranches / N << ", " << formatDouble(numSeconds / N, 5) << std::endl;
+        }
+    }
+}
+
 int main(int argc, const char* argv[])
 {
-    if ((argc < 2) || (!validMethod(argv[1]) && (strcmp(argv[1], "all") != 0)))
+    if ((argc < 2) || (!validMethod(argv[1]) && (strcmp(argv[1], "all") != 0) && (strcmp(argv[1], "maximum") != 0)))
     {
-        std::cout << "usage: program algorithm [level]" << std::endl;
+        std::cout << "usage: program algorithm [level [option ...]]" << std::endl;
         std::cout << "  e.g. program tomita-et-al" << std::endl;
         std::cout << std::endl;
         for (auto it = Methods.begin(); it != Methods.end(); it++)
@@ -194,15 +376,68 @@ int main(int argc, const char* argv[])
             std::cout << " " << formatText(it->handle, 15) << "use method of " << it->name << std::endl;
         }
         std::cout << " all            use all methods" << std::endl;
+        std::cout << " maximum        find the clique number, by branch and bound, instead of enumerating" << std::endl;
         std::cout << std::endl;
         std::cout << " 0, 1, 2        level of complexity allowed, default is 2 (full complexity)" << std::endl;
         std::cout << std::endl;
+        std::cout << " threads=N      number of worker threads, default is 1; 0 uses every core" << std::endl;
+        std::cout << " order=O        none, index or degeneracy; the order of top-level branches, default is none" << std::endl;
+        std::cout << " local          solve each top-level branch in a compact universe of its own" << std::endl;
+        std::cout << " min=K, max=K   only count maximal cliques of at least / at most K vertices" << std::endl;
+        std::cout << " colour         bound min=K by a greedy colouring of the candidates" << std::endl;
+        std::cout << " batch=N        deliver cliques to the receiver in batches of N" << std::endl;
+        std::cout << " kernels=K      portable, popcnt, avx2 or avx512; the set operations to use, default is the best supported" << std::endl;
+        std::cout << " stats=F        csv or json; the format in which the *-stats methods write the counts" << std::endl;
+        std::cout << "                of each search tree, to a file named after the method and benchmark" << std::endl;
+        std::cout << std::endl;
         std::cout << " important note: all required benchmark files must be in the working directory" << std::endl;
     }
     else
     {
         int level = 2;
         if (argc >= 3) level = atoi(argv[2]);
+        CliqueEnumerationOptions options;
+        bool configured = false;
+        std::size_t batch = 0;
+        for (int a = 3; a < argc; a++)
+        {
+            if (strncmp(argv[a], "batch=", 6) == 0)
+            {
+                batch = (std::size_t)atoi(argv[a] + 6);
+                continue;
+            }
+            if (strncmp(argv[a], "kernels=", 8) == 0)
+            {
+                BitKernels kernels[] = { BitKernels::Portable, BitKernels::Popcnt, BitKernels::AVX2, BitKernels::AVX512 };
+                bool selected = false;
+                for (BitKernels k : kernels)
+                {
+                    if (strcmp(argv[a] + 8, bitKernelsName(k)) == 0) selected = selectBitKernels(k);
+                }
+                if (!selected)
+                {
+                    std::cout << "Fatal error: kernels " << (argv[a] + 8) << " are not known or not supported" << std::endl;
+                    return -1;
+                }
+                continue;
+            }
+            if ((strcmp(argv[a], "stats=csv") == 0) || (strcmp(argv[a], "stats=json") == 0))
+            {
+                StatisticsFormat = argv[a] + 6;
+                continue;
+            }
+            if (!parseOption(argv[a], options))
+            {
+                std::cout << "Fatal error: option " << argv[a] << " is not understood" << std::endl;
+                return -1;
+            }
+            configured = true;
+        }
+        if (options.minSize > options.maxSize)
+        {
+            std::cout << "Fatal error: min=" << options.minSize << " exceeds max=" << options.maxSize << std::endl;
+            return -1;
+        }
 
         for (std::size_t t = 0; t < FixedBenchmarks.size(); t++)
         {
@@ -222,11 +457,34 @@ int main(int argc, const char* argv[])
         }
 
         std::string goal = argv[1];
+        if (goal == "maximum")
+        {
+            benchmarkMaximumClique(level);
+            return 0;
+        }
+        else
         if (goal == "all")
         {
             goal = "";
         }
 
+        /// Each benchmark file is loaded once, and every method is handed a clone of the graph.
+        std::vector<SharedGraph> loaded(FixedBenchmarks.size());
+        std::vector<bool> isLoaded(FixedBenchmarks.size(), false);
+        for (std::size_t t = 0; t < FixedBenchmarks.size(); t++)
+        {
+            if (FixedBenchmarks[t].level <= level)
+            {
+                GraphLoader loader(selectPathTo(FixedBenchmarks[t].filename));
+
+                if (loader.isOpen())
+                {
+                    loaded[t] = SharedGraph(loader.loadDIMACSB());
+                    isLoaded[t] = true;
+                }
+            }
+        }
+
         std::cout << "method, benchmark, num_cliques, num_rec_calls, seconds" << std::endl;
         for (std::size_t m = 0; m < Methods.size(); m++)
         {
@@ -236,26 +494,24 @@ int main(int argc, const char* argv[])
 
             for (std::size_t t = 0; t < FixedBenchmarks.size(); t++)
             {
-                if (FixedBenchmarks[t].level <= level)
+                if (isLoaded[t])
                 {
-                    GraphLoader loader(selectPathTo(FixedBenchmarks[t].filename));
+                    SharedGraph graph = loaded[t].clone();
+                    const Graph* g = graph.get();
 
-                    if (loader.isOpen())
-                    {
-                        Graph* g = loader.loadDIMACSB();
+                    CountingCliqueReceiver cr(batch);
+                    StopWatch sw;
 
-                        CliqueReceiver cr;
-                        StopWatch sw;
-
-                        sw.start();
+                    sw.start();
+                    if (configured)
+                        cm.configuredEnumerator(g, &cr, options);
+                    else
                         cm.enumerator(g, &cr);
-                        sw.stop();
-
-                        double seconds = sw.elapsedSeconds();
-                        std::cout << cm.handle << ", " << FixedBenchmarks[t].name << ", " << cr.cliqueCount() << ", " << cr.recursionCount() << ", " << formatDouble(seconds, 5) << std::endl;
+                    sw.stop();
 
-                        delete g;
-                    }
+                    double seconds = sw.elapsedSeconds();
+                    std::cout << cm.handle << ", " << FixedBenchmarks[t].name << ", " << cr.cliqueCount() << ", " << cr.recursionCount() << ", " << formatDouble(seconds, 5) << std::endl;
+                    saveStatistics(cm.handle, FixedBenchmarks[t].name);
                 }
             }
 
@@ -278,11 +534,14 @@ int main(int argc, const char* argv[])
                     {
                         Graph* g = ErdosRenyi::Gnp(random, SyntheticBenchmarks[t].n, SyntheticBenchmarks[t].p, nullptr, nullptr);
 
-                        CliqueReceiver cr;
+                        CountingCliqueReceiver cr(batch);
                         StopWatch sw;
 
                         sw.start();
-                        cm.enumerator(g, &cr);
+                        if (configured)
+                            cm.configuredEnumerator(g, &cr, options);
+                        else
+                            cm.enumerator(g, &cr);
                         sw.stop();
 
                         double seconds = sw.elapsedSeconds();
@@ -298,6 +557,7 @@ int main(int argc, const char* argv[])
                     uint64_t avgCalls = numCalls / N;
                     double avgSeconds = numSeconds / N;
                     std::cout << cm.handle << ", " << "Gnp(n=" << SyntheticBenchmarks[t].n << "; p=" << formatDouble(SyntheticBenchmarks[t].p, 3) << "), " << avgCliques << ", " << avgCalls << ", " << formatDouble(avgSeconds, 5) << std::endl;
+                    saveStatistics(cm.handle, "Gnp_" + std::to_string(SyntheticBenchmarks[t].n) + "_" + formatDouble(SyntheticBenchmarks[t].p, 3));
                 }
             }
         }
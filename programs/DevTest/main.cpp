@@ -8,14 +8,835 @@
  */
 
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <algorithm>
 #include <Matrix.hpp>
 #include <Graph.hpp>
 #include <AssignmentSolver.hpp>
 #include <GraphSimilarity.hpp>
+#include <CompressedIntegerSet.hpp>
+#include <MersenneTwister.hpp>
+#include <CliqueEnumeration.hpp>
+#include <Graph_ErdosRenyi.hpp>
+#include <BKSearch.hpp>
+#include <StopWatch.hpp>
+#include <set>
 
 using namespace kn;
 
+/// A receiver which keeps every clique, as a sorted list of vertex indices.  Workers share it.
+class CollectingCliqueReceiver : public CliqueReceiver
+{
+public:
+    std::vector<std::vector<std::size_t>> cliques;
+
+    virtual void onClique(const Graph& graph, const IntegerSet& vertices)
+    {
+        std::vector<std::size_t> clique;
+        for (auto it = vertices.iterator(); it.hasNext(); )
+        {
+            clique.push_back(it.next());
+        }
+        cliques.push_back(clique);
+    }
+
+    /// The cliques in a canonical order, for comparison with another enumeration.
+    std::vector<std::vector<std::size_t>> sorted() const
+    {
+        std::vector<std::vector<std::size_t>> result = cliques;
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+};
+
+/// The cliques of reference having between minSize and maxSize vertices.
+std::vector<std::vector<std::size_t>> withinBounds(const std::vector<std::vector<std::size_t>>& reference, std::size_t minSize, std::size_t maxSize)
+{
+    std::vector<std::vector<std::size_t>> result;
+    for (const std::vector<std::size_t>& clique : reference)
+    {
+        if ((clique.size() >= minSize) && (clique.size() <= maxSize)) result.push_back(clique);
+    }
+    return result;
+}
+
+/**
+* Checks the size bounds of the configurable enumerators against an unbounded serial enumeration,
+* over both pivots, serial and parallel, whole and local branches, and with or without the colour
+* bound.  The bounds include empty ranges, where minSize exceeds maxSize.  Returns the failures.
+*/
+std::size_t testCliqueBounds(std::size_t trials)
+{
+    MersenneTwister random(5678);
+    std::size_t failures = 0;
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        Graph* g = ErdosRenyi::Gnp(random, 10 + random.nextUInt(50), 0.2 + 0.6 * random.nextDoubleCO(), nullptr, nullptr);
+        CollectingCliqueReceiver all;
+        AllCliques_Tomita(g, &all);
+        std::vector<std::vector<std::size_t>> reference = all.sorted();
+
+        for (unsigned mode = 0; mode < 16; mode++)
+        {
+            CliqueEnumerationOptions options;
+            options.numThreads = (mode & 1) ? 3 : 1;
+            options.localBranches = (mode & 2) != 0;
+            options.colourBound = (mode & 4) != 0;
+            options.minSize = random.nextUInt(8);
+            options.maxSize = random.nextUInt(8);
+            if (random.nextUInt(4) == 0) options.maxSize = ~(std::size_t)0;
+
+            CollectingCliqueReceiver bounded;
+            if (mode & 8) AllCliques_Naude(g, &bounded, options);
+            else AllCliques_Tomita(g, &bounded, options);
+
+            if (bounded.sorted() != withinBounds(reference, options.minSize, options.maxSize))
+            {
+                failures++;
+                std::cout << "Clique bounds: " << options.minSize << " to " << options.maxSize
+                          << " differ in trial " << trial << ", mode " << mode << std::endl;
+            }
+        }
+        delete g;
+    }
+    std::cout << "Clique bounds: " << trials << " trials, " << failures << " failures" << std::endl;
+    return failures;
+}
+
+/// Whether the set holds exactly the members of reference, whichever way it is read, and keeps its window.
+bool same(const IntegerSet& s, const std::vector<bool>& reference)
+{
+    if (!s.verifyWindow() || (s.getMaxCardinality() != reference.size())) return false;
+
+    std::vector<uint32_t> members;
+    for (std::size_t v = 0; v < reference.size(); v++)
+    {
+        if (reference[v]) members.push_back((uint32_t)v);
+    }
+    if ((s.count() != members.size()) || (s.isEmpty() != members.empty())) return false;
+    std::size_t none = s.getMaxCardinality();
+    if (s.firstElement() != (members.empty() ? none : members.front())) return false;
+    if (s.lastElement() != (members.empty() ? none : members.back())) return false;
+
+    std::vector<uint32_t> visited;
+    for (auto it = s.iterator(); it.hasNext(); )
+    {
+        visited.push_back((uint32_t)it.next());
+    }
+    std::vector<uint32_t> decoded(reference.size() + IntegerSet::DecodePadding);
+    decoded.resize(s.decode(decoded.data()));
+    if ((visited != members) || (decoded != members)) return false;
+
+    for (std::size_t v = 0; v <= reference.size(); v++)
+    {
+        if (s.contains(v) != ((v < reference.size()) && reference[v])) return false;
+    }
+    return true;
+}
+
+/// Fills both alike: with nothing, a cluster of nearby values, values scattered over the universe, or most values.
+void randomise(IntegerSet& s, std::vector<bool>& reference, Random& random)
+{
+    std::size_t n = reference.size();
+    s.clear();
+    reference.assign(n, false);
+
+    std::size_t low = 0;
+    std::size_t span = n;
+    std::size_t elements = 0;
+    switch (random.nextUInt(4))
+    {
+    case 0: break;
+    case 1: low = random.nextUInt((uint32_t)n); span = std::min(n - low, (std::size_t)1 + random.nextUInt(300)); elements = 1 + random.nextUInt(60); break;
+    case 2: elements = 1 + random.nextUInt(100); break;
+    case 3: elements = n; break;
+    }
+    for (std::size_t k = 0; k < elements; k++)
+    {
+        std::size_t v = low + random.nextUInt((uint32_t)span);
+        s.add(v);
+        reference[v] = true;
+    }
+}
+
+/// The number of values held by both a and b.
+std::size_t countCommon(const std::vector<bool>& a, const std::vector<bool>& b)
+{
+    std::size_t sum = 0;
+    for (std::size_t v = 0; v < a.size(); v++)
+    {
+        if (a[v] && b[v]) sum++;
+    }
+    return sum;
+}
+
+/**
+* Checks every operation of IntegerSet against a plain vector of flags, with the kernels now selected.
+* The universes run either side of WindowWords words, so that sets with and without a window meet
+* narrow, wide and empty windows, and the rows of an IntegerSetPool are checked along with plain sets.
+* After each operation, the set must still hold no element outside its window.  Returns the failures.
+*/
+std::size_t testIntegerSet(std::size_t trials)
+{
+    MersenneTwister random(4321);
+    std::size_t failures = 0;
+    auto check = [&failures](bool ok, const char* what, std::size_t trial)
+    {
+        if (!ok)
+        {
+            failures++;
+            std::cout << "IntegerSet (" << bitKernelsName(activeBitKernels()) << "): " << what << " differs in trial " << trial << std::endl;
+        }
+    };
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        std::size_t n = 1 + random.nextUInt(3 * 64 * IntegerSet::WindowWords);
+        IntegerSet a(n), b(n), r(n);
+        std::vector<bool> ra(n), rb(n), rr(n);
+        randomise(a, ra, random);
+        randomise(b, rb, random);
+        check(same(a, ra) && same(b, rb), "add", trial);
+
+        for (std::size_t k = 0; k < 50; k++)
+        {
+            std::size_t v = random.nextUInt((uint32_t)n);
+            a.remove(v);
+            ra[v] = false;
+        }
+        check(same(a, ra), "remove", trial);
+
+        std::size_t common = countCommon(ra, rb);
+        std::size_t limit = random.nextUInt(20);
+        std::size_t w = n;
+        std::size_t counted = a.countCommonLimit(b, limit, w);
+        check((a.countCommon(b) == common) && (a.count() == countCommon(ra, ra)), "count and countCommon", trial);
+        check((common < limit) ? (counted == common) : ((counted >= limit) && (counted <= common)), "countCommonLimit", trial);
+        check((counted == 0) || (ra[w] && rb[w]), "countCommonLimit witness", trial);
+        check(std::min(a.countLimit(limit), limit) == std::min(a.count(), limit), "countLimit", trial);
+
+        for (std::size_t v = 0; v < n; v++)
+        {
+            rr[v] = ra[v] && rb[v];
+        }
+        r.intersection(a, b);
+        check(same(r, rr), "intersection", trial);
+        check((r.intersectionCount(a, b) == common) && same(r, rr), "intersectionCount", trial);
+        check((r.intersectionAny(a, b) == (common != 0)) && same(r, rr), "intersectionAny", trial);
+        r.copy(a);
+        r.intersectWith(b);
+        check(same(r, rr), "intersectWith", trial);
+        r.copy(a);
+        check((r.intersectWithAny(b) == (common != 0)) && same(r, rr), "intersectWithAny", trial);
+
+        for (std::size_t v = 0; v < n; v++)
+        {
+            rr[v] = ra[v] || rb[v];
+        }
+        r.copy(a);
+        r.unionWith(b);
+        check(same(r, rr), "unionWith", trial);
+
+        for (std::size_t v = 0; v < n; v++)
+        {
+            rr[v] = ra[v] && !rb[v];
+        }
+        r.copy(a);
+        r.removeAll(b);
+        check(same(r, rr), "removeAll", trial);
+
+        for (std::size_t v = 0; v < n; v++)
+        {
+            rr[v] = !ra[v];
+        }
+        r.copy(a);
+        r.invert();
+        check(same(r, rr), "invert", trial);
+
+        std::size_t v = random.nextUInt((uint32_t)n);
+        r.copy(a);
+        r.fillBefore(v);
+        for (std::size_t k = 0; k < n; k++)
+        {
+            rr[k] = ra[k] || (k < v);
+        }
+        check(same(r, rr), "fillBefore", trial);
+        r.copy(a);
+        r.fillAfter(v);
+        for (std::size_t k = 0; k < n; k++)
+        {
+            rr[k] = ra[k] || (k > v);
+        }
+        check(same(r, rr), "fillAfter", trial);
+
+        r.copy(a);
+        r.removeShift(v);
+        rr = ra;
+        rr.erase(rr.begin() + v);
+        rr.push_back(false);
+        check(same(r, rr), "removeShift", trial);
+
+        r.fill();
+        rr.assign(n, true);
+        check(same(r, rr), "fill", trial);
+        r.clear();
+        rr.assign(n, false);
+        check(same(r, rr), "clear", trial);
+
+        IntegerSet copied(a);
+        IntegerSet assigned;
+        assigned = b;
+        check(same(copied, ra) && same(assigned, rb), "copy construction and assignment", trial);
+
+        /// Rows of a pool, which are views into one slab, scored against a in a batch.
+        std::size_t numRows = 1 + random.nextUInt(2 * IntegerSet::CountCommonBatchSize);
+        IntegerSetPool pool(numRows, n);
+        std::vector<std::vector<bool>> rows(numRows, std::vector<bool>(n));
+        std::vector<const IntegerSet*> pointers;
+        for (std::size_t row = 0; row < numRows; row++)
+        {
+            randomise(pool[row], rows[row], random);
+            check(same(pool[row], rows[row]), "pool row", trial);
+            pointers.push_back(&pool[row]);
+        }
+        std::vector<std::size_t> counts(numRows);
+        for (std::size_t row = 0; row < numRows; row += IntegerSet::CountCommonBatchSize)
+        {
+            std::size_t batch = std::min(IntegerSet::CountCommonBatchSize, numRows - row);
+            a.countCommonBatch(pointers.data() + row, batch, counts.data() + row);
+        }
+        for (std::size_t row = 0; row < numRows; row++)
+        {
+            check(counts[row] == countCommon(ra, rows[row]), "countCommonBatch", trial);
+        }
+
+        /// Shrinking and growing the universe, which may take the set across WindowWords.
+        std::size_t m = 1 + random.nextUInt((uint32_t)(2 * n));
+        a.setMaxCardinality(m);
+        ra.resize(m, false);
+        check(same(a, ra), "setMaxCardinality", trial);
+        std::size_t u = random.nextUInt((uint32_t)m);
+        a.add(u);
+        ra[u] = true;
+        check(same(a, ra), "add after setMaxCardinality", trial);
+    }
+    std::cout << "IntegerSet (" << bitKernelsName(activeBitKernels()) << "): " << trials << " trials, " << failures << " failures" << std::endl;
+    return failures;
+}
+
+/// Runs testIntegerSet with each set of kernels the processor supports, and then restores the choice made at startup.
+std::size_t testBitKernels(std::size_t trials)
+{
+    BitKernels chosen = activeBitKernels();
+    BitKernels kernels[] = { BitKernels::Portable, BitKernels::Popcnt, BitKernels::AVX2, BitKernels::AVX512 };
+    std::size_t failures = 0;
+    for (BitKernels k : kernels)
+    {
+        if (selectBitKernels(k))
+        {
+            failures += testIntegerSet(trials);
+        }
+        else
+        {
+            std::cout << "IntegerSet (" << bitKernelsName(k) << "): not supported here" << std::endl;
+        }
+    }
+    selectBitKernels(chosen);
+    return failures;
+}
+
+/// Whether the compressed set holds exactly the elements of the reference set, in the same order.
+bool same(const CompressedIntegerSet& c, const IntegerSet& s)
+{
+    if ((c.count() != s.count()) || (c.isEmpty() != s.isEmpty())) return false;
+    if (!c.isEmpty() && ((c.firstElement() != s.firstElement()) || (c.lastElement() != s.lastElement()))) return false;
+
+    auto i = c.iterator();
+    auto j = s.iterator();
+    while (j.hasNext())
+    {
+        std::size_t value = j.next();
+        if (!i.hasNext() || (i.next() != value) || !c.contains(value)) return false;
+    }
+    return !i.hasNext();
+}
+
+/**
+* Fills both sets alike.  Each chunk is left empty or given a few elements, a few thousand either side
+* of the ArrayLimit, or most of its values, so that pairs of sets meet every combination of array and
+* bitmap chunks, and small arrays meet large ones often enough to gallop.
+*/
+void randomise(CompressedIntegerSet& c, IntegerSet& s, Random& random)
+{
+    c.clear();
+    s.clear();
+    std::size_t n = s.getMaxCardinality();
+    for (std::size_t base = 0; base < n; base += CompressedIntegerSet::ChunkSize)
+    {
+        std::size_t span = std::min(CompressedIntegerSet::ChunkSize, n - base);
+        std::size_t elements = 0;
+        switch (random.nextUInt(5))
+        {
+        case 0: elements = 0; break;
+        case 1: elements = 1 + random.nextUInt(40); break;
+        case 2: elements = CompressedIntegerSet::ArrayLimit / 2 + random.nextUInt(CompressedIntegerSet::ArrayLimit); break;
+        case 3: elements = span / 2 + random.nextUInt((uint32_t)(span / 2)); break;
+        case 4: elements = span; break;
+        }
+        for (std::size_t k = 0; k < elements; k++)
+        {
+            std::size_t value = base + random.nextUInt((uint32_t)span);
+            c.add(value);
+            s.add(value);
+        }
+    }
+}
+
+/// Checks every operation of CompressedIntegerSet against IntegerSet, and returns the number of failures.
+std::size_t testCompressedIntegerSet(std::size_t trials)
+{
+    MersenneTwister random(1234);
+    std::size_t failures = 0;
+    auto check = [&failures](bool ok, const char* what, std::size_t trial)
+    {
+        if (!ok)
+        {
+            failures++;
+            std::cout << "CompressedIntegerSet: " << what << " differs in trial " << trial << std::endl;
+        }
+    };
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        /// A universe of a few chunks, of which the last is usually partial.
+        std::size_t n = 1 + random.nextUInt(4 * CompressedIntegerSet::ChunkSize);
+        IntegerSet sa(n), sb(n), sr(n);
+        CompressedIntegerSet ca(n), cb(n), cr(n);
+        randomise(ca, sa, random);
+        randomise(cb, sb, random);
+        check(same(ca, sa) && same(cb, sb), "add", trial);
+
+        /// Single elements, with some removals taking array chunks across the ArrayLimit and back.
+        for (std::size_t k = 0; k < 2000; k++)
+        {
+            std::size_t value = random.nextUInt((uint32_t)n);
+            if (random.nextUInt(2) == 0)
+            {
+                ca.remove(value);
+                sa.remove(value);
+            }
+            else
+            {
+                ca.add(value);
+                sa.add(value);
+            }
+            check(ca.contains(value) == sa.contains(value), "contains", trial);
+        }
+        check(!ca.contains(n), "contains beyond the universe", trial);
+        check(same(ca, sa), "add and remove", trial);
+
+        check(ca.countCommon(cb) == sa.countCommon(sb), "countCommon", trial);
+        check(ca.countCommon(sb) == sa.countCommon(sb), "countCommon with IntegerSet", trial);
+
+        cr.intersection(ca, cb);
+        sr.intersection(sa, sb);
+        check(same(cr, sr), "intersection", trial);
+
+        cr.intersection(ca, sb);
+        check(same(cr, sr), "intersection with IntegerSet", trial);
+
+        cr = ca;
+        cr.intersectWith(cb);
+        check(same(cr, sr), "intersectWith", trial);
+
+        cr = ca;
+        cr.intersectWith(sb);
+        check(same(cr, sr), "intersectWith IntegerSet", trial);
+
+        cr = ca;
+        cr.unionWith(cb);
+        sr.copy(sa);
+        sr.unionWith(sb);
+        check(same(cr, sr), "unionWith", trial);
+
+        cr = ca;
+        cr.removeAll(cb);
+        sr.copy(sa);
+        sr.removeAll(sb);
+        check(same(cr, sr), "removeAll", trial);
+
+        cr = ca;
+        cr.removeAll(sb);
+        check(same(cr, sr), "removeAll IntegerSet", trial);
+
+        cr.copy(sb);
+        check(same(cr, sb), "copy", trial);
+
+        ca.copyTo(sr);
+        check(same(ca, sr), "copyTo", trial);
+
+        std::size_t m = random.nextUInt((uint32_t)n) + 1;
+        ca.setMaxCardinality(m);
+        sa.setMaxCardinality(m);
+        check(same(ca, sa), "setMaxCardinality", trial);
+
+        ca.clear();
+        check(ca.isEmpty() && (ca.firstElement() == m) && (ca.count() == 0), "clear", trial);
+    }
+
+    /// The example of the header: ten elements, one to a chunk, in a universe of a million.
+    CompressedIntegerSet sparse(1000000);
+    for (std::size_t k = 0; k < 10; k++)
+    {
+        sparse.add(k * 100000);
+    }
+    std::cout << "CompressedIntegerSet: " << trials << " trials, " << failures << " failures; "
+              << "ten elements in a universe of a million take " << sparse.memoryUsage() << " bytes" << std::endl;
+    return failures;
+}
+
+/**
+* Runs an enumeration to completion in pieces: each run stops after about recursionLimit recursive
+* calls, and its checkpoint is saved, loaded back and resumed by the next.  The cliques of every run
+* are gathered into cliques, and the counts reported by the receivers into counted.  Returns false
+* if a checkpoint does not survive the round trip, or the runs never finish.
+*/
+bool enumerateInPieces(const Graph* g, bool naude, CliqueEnumerationOptions options, CancellationToken* cancel,
+    std::vector<std::vector<std::size_t>>& cliques, uint64_t& counted)
+{
+    CliqueCheckpoint left;
+    CliqueCheckpoint resumed;
+    options.checkpoint = &left;
+    options.resume = nullptr;
+    options.cancellation = cancel;
+    counted = 0;
+
+    for (std::size_t run = 0; run < 100000; run++)
+    {
+        CollectingCliqueReceiver receiver;
+        if (naude) AllCliques_Naude(g, &receiver, options);
+        else AllCliques_Tomita(g, &receiver, options);
+        cliques.insert(cliques.end(), receiver.cliques.begin(), receiver.cliques.end());
+        counted += receiver.cliqueCount();
+        if (left.isComplete()) return true;
+
+        std::stringstream saved;
+        left.save(saved);
+        std::string text = saved.str();
+        if (!resumed.load(saved)) return false;
+        std::stringstream again;
+        resumed.save(again);
+        if (again.str() != text) return false;
+
+        /// Once cancelled, the run which follows is left to finish.
+        options.resume = &resumed;
+        options.cancellation = nullptr;
+    }
+    return false;
+}
+
+/**
+* Checks cancelled, limited and resumed enumeration against a single serial run: over all the runs
+* needed to finish, each clique must be reported exactly once, and the counts of the receivers must
+* agree.  Every mode is tried: both pivots, each ordering, serial and parallel, and local branches.
+* Malformed checkpoints must be refused.  Returns the failures.
+*/
+std::size_t testCheckpoints(std::size_t trials)
+{
+    MersenneTwister random(8765);
+    std::size_t failures = 0;
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        Graph* g = ErdosRenyi::Gnp(random, 20 + random.nextUInt(100), 0.2 + 0.5 * random.nextDoubleCO(), nullptr, nullptr);
+        CollectingCliqueReceiver all;
+        AllCliques_Tomita(g, &all);
+        std::vector<std::vector<std::size_t>> reference = all.sorted();
+
+        for (unsigned mode = 0; mode < 24; mode++)
+        {
+            BranchOrdering orderings[] = { BranchOrdering::None, BranchOrdering::Index, BranchOrdering::Degeneracy };
+            CliqueEnumerationOptions options;
+            options.ordering = orderings[mode % 3];
+            options.numThreads = ((mode / 3) & 1) ? 3 : 1;
+            options.localBranches = ((mode / 3) & 2) != 0;
+            options.recursionLimit = 1 + random.nextUInt(4000);
+
+            /// A run cancelled before it begins must leave all of its work to the checkpoint.
+            CancellationToken cancel;
+            if (random.nextUInt(4) == 0) cancel.cancel();
+
+            std::vector<std::vector<std::size_t>> cliques;
+            uint64_t counted = 0;
+            bool finished = enumerateInPieces(g, (mode / 12) != 0, options, &cancel, cliques, counted);
+            std::sort(cliques.begin(), cliques.end());
+            if (!finished || (cliques != reference) || (counted != reference.size()))
+            {
+                failures++;
+                std::cout << "Checkpoints: mode " << mode << " differs in trial " << trial << std::endl;
+            }
+        }
+        delete g;
+    }
+
+    const char* malformed[] = { "", "clique-checkpoint 2\n0 3 0 0\n", "clique-checkpoint 1\n0 3 4 0\n",
+        "clique-checkpoint 1\n0 3 0 1\n1 5 0 0\n", "clique-checkpoint 1\n0 3 0 1\n1 0\n" };
+    for (const char* text : malformed)
+    {
+        std::stringstream in(text);
+        CliqueCheckpoint checkpoint;
+        if (checkpoint.load(in))
+        {
+            failures++;
+            std::cout << "Checkpoints: a malformed checkpoint was accepted" << std::endl;
+        }
+    }
+
+    std::cout << "Checkpoints: " << trials << " trials, " << failures << " failures" << std::endl;
+    return failures;
+}
+
+/// Keeps the maximal cliques of a graph up to date from the changes reported by IncrementalCliques.
+class MaintainedCliques : public CliqueChangeReceiver
+{
+public:
+    std::set<std::vector<std::size_t>> cliques;
+    bool consistent = true;     /// whether every clique destroyed was held, and every clique created was not
+
+    static std::vector<std::size_t> members(const IntegerSet& vertices)
+    {
+        std::vector<std::size_t> clique;
+        for (auto it = vertices.iterator(); it.hasNext(); )
+        {
+            clique.push_back(it.next());
+        }
+        return clique;
+    }
+
+    virtual void onCliqueCreated(const Graph& graph, const IntegerSet& vertices)
+    {
+        if (!cliques.insert(members(vertices)).second) consistent = false;
+    }
+
+    virtual void onCliqueDestroyed(const Graph& graph, const IntegerSet& vertices)
+    {
+        if (cliques.erase(members(vertices)) == 0) consistent = false;
+    }
+};
+
+/**
+* Checks IncrementalCliques against full enumeration.  Batches of random edge insertions and removals
+* are applied to a graph, and the cliques reported as created and destroyed are applied to the cliques
+* held before, which must then be the maximal cliques of the changed graph.  Returns the failures.
+*/
+template <typename PivotPolicy>
+std::size_t testIncrementalCliques(std::size_t trials, const char* name)
+{
+    MersenneTwister random(2468);
+    std::size_t failures = 0;
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        std::size_t n = 2 + random.nextUInt(60);
+        Graph* g = ErdosRenyi::Gnp(random, (uint32_t)n, 0.1 + 0.7 * random.nextDoubleCO(), nullptr, nullptr);
+
+        CollectingCliqueReceiver initial;
+        AllCliques_Tomita(g, &initial);
+        MaintainedCliques maintained;
+        for (const std::vector<std::size_t>& clique : initial.cliques)
+        {
+            maintained.cliques.insert(clique);
+        }
+
+        IncrementalCliques<PivotPolicy> incremental(g);
+        for (std::size_t batch = 0; batch < 20; batch++)
+        {
+            std::vector<Graph::Pair> inserted;
+            std::vector<Graph::Pair> removed;
+            std::set<std::pair<std::size_t, std::size_t>> chosen;
+            std::size_t changes = 1 + random.nextUInt(batch % 2 ? 2 : 12);
+            for (std::size_t k = 0; k < changes; k++)
+            {
+                std::size_t u = random.nextUInt((uint32_t)n);
+                std::size_t v = random.nextUInt((uint32_t)n);
+                if ((u == v) || !chosen.insert(std::make_pair(std::min(u, v), std::max(u, v))).second) continue;
+
+                if (g->hasEdge(u, v))
+                {
+                    removed.push_back(Graph::Pair(u, v));
+                    g->removeEdge(u, v);
+                }
+                else
+                {
+                    inserted.push_back(Graph::Pair(u, v));
+                    g->addEdge(u, v, 0);
+                }
+            }
+            incremental.update(inserted, removed, &maintained);
+
+            CollectingCliqueReceiver full;
+            AllCliques_Tomita(g, &full);
+            std::vector<std::vector<std::size_t>> expected = full.sorted();
+            std::vector<std::vector<std::size_t>> held(maintained.cliques.begin(), maintained.cliques.end());
+            if (!maintained.consistent || (held != expected))
+            {
+                failures++;
+                std::cout << "IncrementalCliques (" << name << "): batch " << batch << " differs in trial " << trial << std::endl;
+                break;
+            }
+        }
+        delete g;
+    }
+    std::cout << "IncrementalCliques (" << name << "): " << trials << " trials, " << failures << " failures" << std::endl;
+    return failures;
+}
+
+/// Whether g answers as the unindexed reference does, for every pair of the first numIDs vertex IDs and one beyond.
+bool sameArcs(const Graph& g, const Graph& reference, std::size_t numIDs)
+{
+    std::vector<Graph::Pair> pairs;
+    for (std::size_t u = 0; u <= numIDs; u++)
+    {
+        for (std::size_t v = 0; v <= numIDs; v++)
+        {
+            if ((g.hasArc(u, v) != reference.hasArc(u, v)) || (g.hasEdge(u, v) != reference.hasEdge(u, v))) return false;
+            pairs.push_back(Graph::Pair(u, v));
+        }
+    }
+    return g.hasArcs(pairs) == reference.hasArcs(pairs);
+}
+
+/// The seconds taken to add vertices to a graph of start vertices, each with an arc to an older vertex.
+double growWithArcs(Graph::ArcIndex index, std::size_t start, std::size_t added)
+{
+    Graph g;
+    g.setArcIndex(index);
+    for (std::size_t k = 0; k < start; k++)
+    {
+        g.addVertex(0);
+    }
+
+    StopWatch sw;
+    sw.start();
+    for (std::size_t k = 0; k < added; k++)
+    {
+        Graph::VertexID v = g.addVertex(0);
+        g.addArc(v, k % start, 0);
+    }
+    sw.stop();
+    return sw.elapsedSeconds();
+}
+
+/**
+* Checks each kind of arc index against a graph without one, under random additions and removals of
+* vertices, arcs and edges, changes of index, copies, assignments and moves.  Graphs grow past 4096
+* vertices now and then, so that Automatic meets both of its forms.  Lastly, interleaved additions of
+* vertices and arcs must not make Automatic much slower than either fixed form, as they would if it
+* kept switching between them.  Returns the failures.
+*/
+std::size_t testArcIndex(std::size_t trials)
+{
+    MersenneTwister random(1357);
+    std::size_t failures = 0;
+    Graph::ArcIndex kinds[] = { Graph::ArcIndex::None, Graph::ArcIndex::Dense, Graph::ArcIndex::Sparse, Graph::ArcIndex::Automatic };
+
+    for (std::size_t trial = 0; trial < trials; trial++)
+    {
+        Graph reference;
+        Graph g;
+        g.setArcIndex(kinds[trial % 4]);
+        std::size_t numIDs = 1 + random.nextUInt(150);
+        if (trial % 10 == 9) numIDs += 4096;
+        for (std::size_t k = 0; k < numIDs; k++)
+        {
+            reference.addVertex(0);
+            g.addVertex(0);
+        }
+
+        bool ok = true;
+        for (std::size_t step = 0; (step < 3000) && ok; step++)
+        {
+            std::size_t u = random.nextUInt((uint32_t)numIDs);
+            std::size_t v = random.nextUInt((uint32_t)numIDs);
+            uint32_t op = random.nextUInt(100);
+            if (op < 40)
+            {
+                reference.addArc(u, v, 0);
+                g.addArc(u, v, 0);
+            }
+            else
+            if (op < 50)
+            {
+                reference.addEdge(u, v, 0);
+                g.addEdge(u, v, 0);
+            }
+            else
+            if (op < 75)
+            {
+                reference.removeEdge(u, v);
+                g.removeEdge(u, v);
+            }
+            else
+            if (op < 80)
+            {
+                reference.removeVertex(u);
+                g.removeVertex(u);
+            }
+            else
+            if (op < 90)
+            {
+                reference.addVertex(0);
+                g.addVertex(0);
+                numIDs++;
+            }
+            else
+            if (op < 92)
+            {
+                g.setArcIndex(kinds[random.nextUInt(4)]);
+            }
+            else
+            if (op < 93)
+            {
+                std::size_t checked = std::min(numIDs, (std::size_t)100);
+                Graph copied(g);
+                ok = sameArcs(copied, reference, checked) && (copied.getArcIndex() == g.getArcIndex());
+                Graph assigned;
+                assigned = g;
+                ok = ok && sameArcs(assigned, reference, checked);
+                Graph moved(std::move(copied));
+                g = std::move(moved);
+            }
+            else
+            {
+                std::size_t a = random.nextUInt((uint32_t)(numIDs + 2));
+                std::size_t b = random.nextUInt((uint32_t)(numIDs + 2));
+                ok = (g.hasArc(a, b) == reference.hasArc(a, b)) && (g.hasEdge(a, b) == reference.hasEdge(a, b));
+            }
+        }
+        if (!ok || !sameArcs(g, reference, std::min(numIDs, (std::size_t)300)))
+        {
+            failures++;
+            std::cout << "Arc index: differs in trial " << trial << std::endl;
+        }
+    }
+
+    for (std::size_t start : { 2048, 6000 })
+    {
+        double automatic = growWithArcs(Graph::ArcIndex::Automatic, start, 2000);
+        double fixed = std::max(growWithArcs(Graph::ArcIndex::Dense, start, 2000), growWithArcs(Graph::ArcIndex::Sparse, start, 2000));
+        if (automatic > 10 * fixed + 0.05)
+        {
+            failures++;
+            std::cout << "Arc index: Automatic takes " << automatic << " seconds to grow from " << start << " vertices, against " << fixed << std::endl;
+        }
+    }
+
+    std::cout << "Arc index: " << trials << " trials, " << failures << " failures" << std::endl;
+    return failures;
+}
+
 void show(Matrix<float> m)
 {
     std::size_t rows = m.countRows();
@@ -33,6 +854,16 @@ void show(Matrix<float> m)
 
 int main(int argc, const char* argv[])
 {
+    std::size_t failures = 0;
+    failures += testBitKernels(300);
+    failures += testCompressedIntegerSet(200);
+    failures += testCliqueBounds(100);
+    failures += testCheckpoints(30);
+    failures += testIncrementalCliques<TomitaPivot>(100, "Tomita");
+    failures += testIncrementalCliques<NaudePivot>(100, "Naude");
+    failures += testArcIndex(120);
+    if (failures != 0) return 1;
+
     ///*
     Graph a;
     a.addVertex(1);
@@ -1,6 +1,22 @@
 
 #include <BitStructures.hpp>
 
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define KN_X86_BIT_KERNELS
+#include <immintrin.h>
+#endif
+
+#if defined(_WIN32)
+#include <malloc.h>
+#else
+#include <stdlib.h>
+#endif
+
+#if defined(__linux__)
+#define KN_HUGE_PAGES
+#include <sys/mman.h>
+#endif
+
 namespace kn
 {
 
@@ -43,15 +59,729 @@ namespace kn
 #undef BitCountTableRow
 
 
+    /**
+    * The bulk kernels work over arrays of n words.  For intersection and difference, r may be a.
+    * countCommonLimit keeps to words one at a time at every level, as its early exit and its
+    * witness w are defined word by word.
+    */
+    namespace
+    {
+        std::size_t countPortable(const uint64_t* a, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                sum += countBits(a[index]);
+            }
+            return sum;
+        }
+
+        std::size_t countCommonPortable(const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                sum += countBits(a[index] & b[index]);
+            }
+            return sum;
+        }
+
+        std::size_t countCommonLimitPortable(const uint64_t* a, const uint64_t* b, std::size_t n, std::size_t limit, std::size_t& w)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                if (bits != 0)
+                {
+                    sum += countBits(bits);
+                    w = index * 64 + bitToIndex(lowestBit(bits)); /// any bit will do
+                    if (sum >= limit) break;
+                }
+            }
+            return sum;
+        }
+
+        void intersectionPortable(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            for (std::size_t index = 0; index < n; index++)
+            {
+                r[index] = a[index] & b[index];
+            }
+        }
+
+        void differencePortable(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            for (std::size_t index = 0; index < n; index++)
+            {
+                r[index] = a[index] & ~b[index];
+            }
+        }
+
+        std::size_t intersectionCountPortable(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                r[index] = bits;
+                sum += countBits(bits);
+            }
+            return sum;
+        }
+
+        bool intersectionAnyPortable(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            uint64_t any = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                r[index] = bits;
+                any |= bits;
+            }
+            return any != 0;
+        }
+
+        /// Writes base plus the index of each bit of the n words, in increasing order, to out.
+        std::size_t decodePortable(const uint64_t* a, std::size_t n, std::size_t base, uint32_t* out)
+        {
+            std::size_t k = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index];
+                while (bits != 0)
+                {
+                    uint64_t bit = lowestBit(bits);
+                    bits ^= bit;
+                    out[k++] = (uint32_t)(base + index * 64 + bitToIndex(bit));
+                }
+            }
+            return k;
+        }
+
+        /// Counts the bits that row has in common with the k non-zero words bits, found at the given indices.
+        std::size_t countSparsePortable(const uint32_t* index, const uint64_t* bits, std::size_t k, const uint64_t* row)
+        {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < k; i++)
+            {
+                sum += countBits(bits[i] & row[index[i]]);
+            }
+            return sum;
+        }
+
+        /// The words of a are scored against the rows a block at a time, so that the block stays in the
+        /// first level cache while every row passes over it.  The non-zero words of each block are listed
+        /// first; where they are few, only the matching words of each row are read at all, and otherwise
+        /// the block is scored densely with the vector kernel of the level.
+        const std::size_t BatchBlockWords = 256;
+
+        template <std::size_t (*CountCommon)(const uint64_t*, const uint64_t*, std::size_t),
+                  std::size_t (*CountSparse)(const uint32_t*, const uint64_t*, std::size_t, const uint64_t*)>
+        void countCommonBatch(const uint64_t* a, const uint64_t* const* rows, std::size_t numRows, std::size_t n, std::size_t* counts)
+        {
+            uint32_t index[BatchBlockWords];
+            uint64_t bits[BatchBlockWords];
+
+            for (std::size_t r = 0; r < numRows; r++)
+            {
+                counts[r] = 0;
+            }
+            for (std::size_t from = 0; from < n; from += BatchBlockWords)
+            {
+                std::size_t length = std::min(BatchBlockWords, n - from);
+                std::size_t k = 0;
+                for (std::size_t i = from; i < from + length; i++)
+                {
+                    if (a[i] != 0)
+                    {
+                        index[k] = (uint32_t)i;
+                        bits[k] = a[i];
+                        k++;
+                    }
+                }
+
+                if (k == 0) continue;
+                if (2 * k >= length)
+                {
+                    for (std::size_t r = 0; r < numRows; r++)
+                    {
+                        counts[r] += CountCommon(a + from, rows[r] + from, length);
+                    }
+                }
+                else
+                {
+                    for (std::size_t r = 0; r < numRows; r++)
+                    {
+                        counts[r] += CountSparse(index, bits, k, rows[r]);
+                    }
+                }
+            }
+        }
+
+#ifdef KN_X86_BIT_KERNELS
+
+        /// Decodes one word by trailing zero counts, which suits words with few bits.
+        __attribute__((target("bmi")))
+        inline std::size_t decodeWordSparse(uint64_t bits, uint32_t offset, uint32_t* out)
+        {
+            std::size_t k = 0;
+            while (bits != 0)
+            {
+                out[k++] = offset + (uint32_t)__builtin_ctzll(bits);
+                bits &= bits - 1;
+            }
+            return k;
+        }
+
+        __attribute__((target("popcnt")))
+        std::size_t countPopcnt(const uint64_t* a, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                sum += (std::size_t)__builtin_popcountll(a[index]);
+            }
+            return sum;
+        }
+
+        __attribute__((target("popcnt")))
+        std::size_t countCommonPopcnt(const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                sum += (std::size_t)__builtin_popcountll(a[index] & b[index]);
+            }
+            return sum;
+        }
+
+        __attribute__((target("popcnt,bmi")))
+        std::size_t countCommonLimitPopcnt(const uint64_t* a, const uint64_t* b, std::size_t n, std::size_t limit, std::size_t& w)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                if (bits != 0)
+                {
+                    sum += (std::size_t)__builtin_popcountll(bits);
+                    w = index * 64 + (std::size_t)__builtin_ctzll(bits);
+                    if (sum >= limit) break;
+                }
+            }
+            return sum;
+        }
+
+        __attribute__((target("popcnt")))
+        std::size_t countSparsePopcnt(const uint32_t* index, const uint64_t* bits, std::size_t k, const uint64_t* row)
+        {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < k; i++)
+            {
+                sum += (std::size_t)__builtin_popcountll(bits[i] & row[index[i]]);
+            }
+            return sum;
+        }
+
+        __attribute__((target("popcnt")))
+        std::size_t intersectionCountPopcnt(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                r[index] = bits;
+                sum += (std::size_t)__builtin_popcountll(bits);
+            }
+            return sum;
+        }
+
+        __attribute__((target("bmi")))
+        std::size_t decodePopcnt(const uint64_t* a, std::size_t n, std::size_t base, uint32_t* out)
+        {
+            std::size_t k = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                if (a[index] != 0) k += decodeWordSparse(a[index], (uint32_t)(base + index * 64), out + k);
+            }
+            return k;
+        }
+
+        /// Counts the bits of each 64-bit lane, by looking up each nibble with a byte shuffle (after Mula).
+        __attribute__((target("avx2")))
+        inline __m256i countLanesAVX2(__m256i v)
+        {
+            const __m256i lookup = _mm256_setr_epi8(
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, nibble));
+            __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+            return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+        }
+
+        __attribute__((target("avx2")))
+        inline std::size_t sumLanesAVX2(__m256i v)
+        {
+            __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            return (std::size_t)(_mm_cvtsi128_si64(sum) + _mm_extract_epi64(sum, 1));
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        std::size_t countAVX2(const uint64_t* a, std::size_t n)
+        {
+            __m256i total = _mm256_setzero_si256();
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(a + index));
+                total = _mm256_add_epi64(total, countLanesAVX2(v));
+            }
+            std::size_t sum = sumLanesAVX2(total);
+            for (; index < n; index++)
+            {
+                sum += (std::size_t)__builtin_popcountll(a[index]);
+            }
+            return sum;
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        std::size_t countCommonAVX2(const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m256i total = _mm256_setzero_si256();
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_and_si256(
+                    _mm256_loadu_si256((const __m256i*)(a + index)),
+                    _mm256_loadu_si256((const __m256i*)(b + index)));
+                total = _mm256_add_epi64(total, countLanesAVX2(v));
+            }
+            std::size_t sum = sumLanesAVX2(total);
+            for (; index < n; index++)
+            {
+                sum += (std::size_t)__builtin_popcountll(a[index] & b[index]);
+            }
+            return sum;
+        }
+
+        __attribute__((target("avx2")))
+        void intersectionAVX2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_and_si256(
+                    _mm256_loadu_si256((const __m256i*)(a + index)),
+                    _mm256_loadu_si256((const __m256i*)(b + index)));
+                _mm256_storeu_si256((__m256i*)(r + index), v);
+            }
+            for (; index < n; index++)
+            {
+                r[index] = a[index] & b[index];
+            }
+        }
+
+        __attribute__((target("avx2")))
+        void differenceAVX2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_andnot_si256(
+                    _mm256_loadu_si256((const __m256i*)(b + index)),
+                    _mm256_loadu_si256((const __m256i*)(a + index)));
+                _mm256_storeu_si256((__m256i*)(r + index), v);
+            }
+            for (; index < n; index++)
+            {
+                r[index] = a[index] & ~b[index];
+            }
+        }
+
+        __attribute__((target("avx2,popcnt")))
+        std::size_t intersectionCountAVX2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m256i total = _mm256_setzero_si256();
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_and_si256(
+                    _mm256_loadu_si256((const __m256i*)(a + index)),
+                    _mm256_loadu_si256((const __m256i*)(b + index)));
+                _mm256_storeu_si256((__m256i*)(r + index), v);
+                total = _mm256_add_epi64(total, countLanesAVX2(v));
+            }
+            std::size_t sum = sumLanesAVX2(total);
+            for (; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                r[index] = bits;
+                sum += (std::size_t)__builtin_popcountll(bits);
+            }
+            return sum;
+        }
+
+        __attribute__((target("avx2")))
+        bool intersectionAnyAVX2(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m256i any = _mm256_setzero_si256();
+            std::size_t index = 0;
+            for (; index + 4 <= n; index += 4)
+            {
+                __m256i v = _mm256_and_si256(
+                    _mm256_loadu_si256((const __m256i*)(a + index)),
+                    _mm256_loadu_si256((const __m256i*)(b + index)));
+                _mm256_storeu_si256((__m256i*)(r + index), v);
+                any = _mm256_or_si256(any, v);
+            }
+            uint64_t rest = 0;
+            for (; index < n; index++)
+            {
+                uint64_t bits = a[index] & b[index];
+                r[index] = bits;
+                rest |= bits;
+            }
+            return (rest != 0) || !_mm256_testz_si256(any, any);
+        }
+
+        /// The indices of the bits of each byte value, padded to eight entries.
+        struct ByteIndexTable
+        {
+            alignas(64) uint8_t indices[256][8];
+
+            ByteIndexTable()
+            {
+                for (int byte = 0; byte < 256; byte++)
+                {
+                    int k = 0;
+                    for (int bit = 0; bit < 8; bit++)
+                    {
+                        if (byte & (1 << bit)) indices[byte][k++] = (uint8_t)bit;
+                    }
+                    while (k < 8) indices[byte][k++] = 0;
+                }
+            }
+        };
+
+        const ByteIndexTable byteIndices;
+
+        /// Words with at least this many bits are decoded with vectors, and the rest by trailing zero counts.
+        const int DenseDecodeBits = 8;
+
+        /// Decodes dense words a byte at a time, by table lookup.  Each byte stores eight indices, of which
+        /// only as many as it has bits are kept.
+
+        __attribute__((target("avx2,popcnt,bmi")))
+        std::size_t decodeAVX2(const uint64_t* a, std::size_t n, std::size_t base, uint32_t* out)
+        {
+            const __m256i eight = _mm256_set1_epi32(8);
+            std::size_t k = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index];
+                if (bits == 0) continue;
+                uint32_t offset = (uint32_t)(base + index * 64);
+                if (__builtin_popcountll(bits) < DenseDecodeBits)
+                {
+                    k += decodeWordSparse(bits, offset, out + k);
+                    continue;
+                }
+                __m256i start = _mm256_set1_epi32((int)offset);
+                for (int shift = 0; shift < 64; shift += 8)
+                {
+                    unsigned byte = (unsigned)(bits >> shift) & 0xFF;
+                    __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)byteIndices.indices[byte]));
+                    _mm256_storeu_si256((__m256i*)(out + k), _mm256_add_epi32(indices, start));
+                    k += (std::size_t)__builtin_popcount(byte);
+                    start = _mm256_add_epi32(start, eight);
+                }
+            }
+            return k;
+        }
+
+        /// The lanes of a final partial vector of 512 bits.
+        inline __mmask8 tailMask(std::size_t remaining)
+        {
+            return (__mmask8)((1u << remaining) - 1);
+        }
+
+        __attribute__((target("avx512f,avx512vpopcntdq")))
+        std::size_t countAVX512(const uint64_t* a, std::size_t n)
+        {
+            __m512i total = _mm512_setzero_si512();
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(_mm512_loadu_si512(a + index)));
+            }
+            if (index < n)
+            {
+                __m512i v = _mm512_maskz_loadu_epi64(tailMask(n - index), a + index);
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+            }
+            return (std::size_t)_mm512_reduce_add_epi64(total);
+        }
+
+        __attribute__((target("avx512f,avx512vpopcntdq")))
+        std::size_t countCommonAVX512(const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m512i total = _mm512_setzero_si512();
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                __m512i v = _mm512_and_si512(_mm512_loadu_si512(a + index), _mm512_loadu_si512(b + index));
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+            }
+            if (index < n)
+            {
+                __mmask8 mask = tailMask(n - index);
+                __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, a + index), _mm512_maskz_loadu_epi64(mask, b + index));
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+            }
+            return (std::size_t)_mm512_reduce_add_epi64(total);
+        }
+
+        __attribute__((target("avx512f")))
+        void intersectionAVX512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                _mm512_storeu_si512(r + index, _mm512_and_si512(_mm512_loadu_si512(a + index), _mm512_loadu_si512(b + index)));
+            }
+            if (index < n)
+            {
+                __mmask8 mask = tailMask(n - index);
+                __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, a + index), _mm512_maskz_loadu_epi64(mask, b + index));
+                _mm512_mask_storeu_epi64(r + index, mask, v);
+            }
+        }
+
+        __attribute__((target("avx512f")))
+        void differenceAVX512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                _mm512_storeu_si512(r + index, _mm512_andnot_si512(_mm512_loadu_si512(b + index), _mm512_loadu_si512(a + index)));
+            }
+            if (index < n)
+            {
+                __mmask8 mask = tailMask(n - index);
+                __m512i v = _mm512_andnot_si512(_mm512_maskz_loadu_epi64(mask, b + index), _mm512_maskz_loadu_epi64(mask, a + index));
+                _mm512_mask_storeu_epi64(r + index, mask, v);
+            }
+        }
+
+        __attribute__((target("avx512f,avx512vpopcntdq")))
+        std::size_t intersectionCountAVX512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m512i total = _mm512_setzero_si512();
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                __m512i v = _mm512_and_si512(_mm512_loadu_si512(a + index), _mm512_loadu_si512(b + index));
+                _mm512_storeu_si512(r + index, v);
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+            }
+            if (index < n)
+            {
+                __mmask8 mask = tailMask(n - index);
+                __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, a + index), _mm512_maskz_loadu_epi64(mask, b + index));
+                _mm512_mask_storeu_epi64(r + index, mask, v);
+                total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+            }
+            return (std::size_t)_mm512_reduce_add_epi64(total);
+        }
+
+        __attribute__((target("avx512f")))
+        bool intersectionAnyAVX512(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n)
+        {
+            __m512i any = _mm512_setzero_si512();
+            std::size_t index = 0;
+            for (; index + 8 <= n; index += 8)
+            {
+                __m512i v = _mm512_and_si512(_mm512_loadu_si512(a + index), _mm512_loadu_si512(b + index));
+                _mm512_storeu_si512(r + index, v);
+                any = _mm512_or_si512(any, v);
+            }
+            if (index < n)
+            {
+                __mmask8 mask = tailMask(n - index);
+                __m512i v = _mm512_and_si512(_mm512_maskz_loadu_epi64(mask, a + index), _mm512_maskz_loadu_epi64(mask, b + index));
+                _mm512_mask_storeu_epi64(r + index, mask, v);
+                any = _mm512_or_si512(any, v);
+            }
+            return _mm512_test_epi64_mask(any, any) != 0;
+        }
+
+        /// Decodes dense words sixteen bits at a time, by compressing a vector of sixteen consecutive indices.
+
+        __attribute__((target("avx512f,popcnt,bmi")))
+        std::size_t decodeAVX512(const uint64_t* a, std::size_t n, std::size_t base, uint32_t* out)
+        {
+            const __m512i sixteen = _mm512_set1_epi32(16);
+            const __m512i ascending = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+            std::size_t k = 0;
+            for (std::size_t index = 0; index < n; index++)
+            {
+                uint64_t bits = a[index];
+                if (bits == 0) continue;
+                uint32_t offset = (uint32_t)(base + index * 64);
+                if (__builtin_popcountll(bits) < DenseDecodeBits)
+                {
+                    k += decodeWordSparse(bits, offset, out + k);
+                    continue;
+                }
+                __m512i indices = _mm512_add_epi32(_mm512_set1_epi32((int)offset), ascending);
+                for (int shift = 0; shift < 64; shift += 16)
+                {
+                    __mmask16 mask = (__mmask16)(bits >> shift);
+                    _mm512_storeu_si512(out + k, _mm512_maskz_compress_epi32(mask, indices));
+                    k += (std::size_t)__builtin_popcount(mask);
+                    indices = _mm512_add_epi32(indices, sixteen);
+                }
+            }
+            return k;
+        }
+
+#endif
+
+        struct KernelTable
+        {
+            BitKernels kind;
+            std::size_t (*count)(const uint64_t* a, std::size_t n);
+            std::size_t (*countCommon)(const uint64_t* a, const uint64_t* b, std::size_t n);
+            std::size_t (*countCommonLimit)(const uint64_t* a, const uint64_t* b, std::size_t n, std::size_t limit, std::size_t& w);
+            void (*intersection)(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n);
+            void (*difference)(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n);
+            std::size_t (*intersectionCount)(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n);
+            bool (*intersectionAny)(uint64_t* r, const uint64_t* a, const uint64_t* b, std::size_t n);
+            void (*countCommonBatch)(const uint64_t* a, const uint64_t* const* rows, std::size_t numRows, std::size_t n, std::size_t* counts);
+            std::size_t (*decode)(const uint64_t* a, std::size_t n, std::size_t base, uint32_t* out);
+        };
+
+        const KernelTable PortableKernels =
+            { BitKernels::Portable, countPortable, countCommonPortable, countCommonLimitPortable, intersectionPortable, differencePortable,
+              intersectionCountPortable, intersectionAnyPortable,
+              countCommonBatch<countCommonPortable, countSparsePortable>, decodePortable };
+
+#ifdef KN_X86_BIT_KERNELS
+        const KernelTable PopcntKernels =
+            { BitKernels::Popcnt, countPopcnt, countCommonPopcnt, countCommonLimitPopcnt, intersectionPortable, differencePortable,
+              intersectionCountPopcnt, intersectionAnyPortable,
+              countCommonBatch<countCommonPopcnt, countSparsePopcnt>, decodePopcnt };
+        const KernelTable AVX2Kernels =
+            { BitKernels::AVX2, countAVX2, countCommonAVX2, countCommonLimitPopcnt, intersectionAVX2, differenceAVX2,
+              intersectionCountAVX2, intersectionAnyAVX2,
+              countCommonBatch<countCommonAVX2, countSparsePopcnt>, decodeAVX2 };
+        const KernelTable AVX512Kernels =
+            { BitKernels::AVX512, countAVX512, countCommonAVX512, countCommonLimitPopcnt, intersectionAVX512, differenceAVX512,
+              intersectionCountAVX512, intersectionAnyAVX512,
+              countCommonBatch<countCommonAVX512, countSparsePopcnt>, decodeAVX512 };
+#endif
+
+        /// Sets constructed before the kernels are chosen (during static initialisation) use the portable ones.
+        const KernelTable* kernels = &PortableKernels;
+
+        const KernelTable* kernelTable(BitKernels kind)
+        {
+#ifdef KN_X86_BIT_KERNELS
+            switch (kind)
+            {
+            case BitKernels::Popcnt: return &PopcntKernels;
+            case BitKernels::AVX2: return &AVX2Kernels;
+            case BitKernels::AVX512: return &AVX512Kernels;
+            default: break;
+            }
+#endif
+            return (kind == BitKernels::Portable) ? &PortableKernels : nullptr;
+        }
+
+        BitKernels bestBitKernels()
+        {
+            if (supportsBitKernels(BitKernels::AVX512)) return BitKernels::AVX512;
+            if (supportsBitKernels(BitKernels::AVX2)) return BitKernels::AVX2;
+            if (supportsBitKernels(BitKernels::Popcnt)) return BitKernels::Popcnt;
+            return BitKernels::Portable;
+        }
+
+        const bool bitKernelsChosen = selectBitKernels(bestBitKernels());
+    }
+
+    bool supportsBitKernels(BitKernels kind)
+    {
+#ifdef KN_X86_BIT_KERNELS
+        __builtin_cpu_init();
+        switch (kind)
+        {
+        case BitKernels::Portable: return true;
+        case BitKernels::Popcnt: return __builtin_cpu_supports("popcnt");
+        case BitKernels::AVX2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+        case BitKernels::AVX512: return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+        }
+        return false;
+#else
+        return (kind == BitKernels::Portable);
+#endif
+    }
+
+    BitKernels activeBitKernels()
+    {
+        return kernels->kind;
+    }
+
+    bool selectBitKernels(BitKernels kind)
+    {
+        const KernelTable* table = kernelTable(kind);
+        if (!table || !supportsBitKernels(kind)) return false;
+        kernels = table;
+        return true;
+    }
+
+    const char* bitKernelsName(BitKernels kind)
+    {
+        switch (kind)
+        {
+        case BitKernels::Portable: return "portable";
+        case BitKernels::Popcnt: return "popcnt";
+        case BitKernels::AVX2: return "avx2";
+        case BitKernels::AVX512: return "avx512";
+        }
+        return "unknown";
+    }
+
+
+    const std::size_t IntegerSet::WindowWords;
+    const std::size_t IntegerSet::CountCommonBatchSize;
+    const std::size_t IntegerSet::DecodePadding;
+
     bool IntegerSet::verifyIsEmpty() const
     {
-        for (std::size_t index = 0; index < arraySize; index++)
+        for (std::size_t index = lowWord; index < highWord; index++)
         {
             if (array[index] != 0) return false;
         }
         return true;
     }
 
+    bool IntegerSet::verifyWindow() const
+    {
+        if (!windowed && ((lowWord != 0) || (highWord != arraySize))) return false;
+        for (std::size_t index = 0; index < arraySize; index++)
+        {
+            bool inside = (index >= lowWord) && (index < highWord);
+            if (!inside && (array[index] != 0)) return false;
+        }
+        if ((maxCardinality & 63) != 0)
+        {
+            if ((array[arraySize - 1] & ~(singleBit(maxCardinality & 63) - 1)) != 0) return false;
+        }
+        return true;
+    }
+
     IntegerSet::IntegerSet()
     {
         maxCardinality = 1;
@@ -59,6 +789,8 @@ namespace kn
         array = new uint64_t[1];
         assert(array);
         array[0] = 0;
+        ownsArray = true;
+        resetWindow();
     }
 
     IntegerSet::IntegerSet(std::size_t maxCardinality)
@@ -67,6 +799,10 @@ namespace kn
         arraySize = (maxCardinality + 63) / 64;
         array = new uint64_t[arraySize];
         assert(array);
+        ownsArray = true;
+        windowed = (arraySize >= WindowWords);
+        lowWord = 0;
+        highWord = arraySize;
         clear();
     }
 
@@ -76,12 +812,16 @@ namespace kn
         arraySize = (maxCardinality + 63) / 64;
         array = new uint64_t[arraySize];
         assert(array);
+        ownsArray = true;
+        windowed = (arraySize >= WindowWords);
+        lowWord = 0;
+        highWord = arraySize;
         copy(pattern);
     }
 
     IntegerSet::~IntegerSet()
     {
-        if (array) delete[] array;
+        if (array && ownsArray) delete[] array;
     }
 
     IntegerSet& IntegerSet::operator=(const IntegerSet& pattern)
@@ -90,10 +830,14 @@ namespace kn
         {
             if (arraySize != pattern.arraySize)
             {
-                delete[] array;
+                if (ownsArray) delete[] array;
                 array = new uint64_t[pattern.arraySize];
                 assert(array);
+                ownsArray = true;
                 arraySize = pattern.arraySize;
+                windowed = (arraySize >= WindowWords);
+                lowWord = 0;
+                highWord = arraySize;
             }
             maxCardinality = pattern.maxCardinality;
 
@@ -104,15 +848,21 @@ namespace kn
 
     /// Move constructor
     IntegerSet::IntegerSet(IntegerSet&& pattern)
-        : maxCardinality(0), arraySize(0), array(nullptr)
+        : maxCardinality(0), arraySize(0), array(nullptr), ownsArray(true), lowWord(0), highWord(0), windowed(false)
     {
         maxCardinality = pattern.maxCardinality;
         arraySize = pattern.arraySize;
         array = pattern.array;
+        ownsArray = pattern.ownsArray;
+        lowWord = pattern.lowWord;
+        highWord = pattern.highWord;
+        windowed = pattern.windowed;
 
         pattern.array = nullptr;
         pattern.arraySize = 0;
         pattern.maxCardinality = 0;
+        pattern.lowWord = 0;
+        pattern.highWord = 0;
     }
 
     /// Move assignment
@@ -120,19 +870,41 @@ namespace kn
     {
         if (this != &pattern)
         {
-            if (array) delete[] array;
+            if (array && ownsArray) delete[] array;
 
             maxCardinality = pattern.maxCardinality;
             arraySize = pattern.arraySize;
             array = pattern.array;
+            ownsArray = pattern.ownsArray;
+            lowWord = pattern.lowWord;
+            highWord = pattern.highWord;
+            windowed = pattern.windowed;
 
             pattern.array = nullptr;
             pattern.arraySize = 0;
             pattern.maxCardinality = 0;
+            pattern.lowWord = 0;
+            pattern.highWord = 0;
         }
         return *this;
     }
 
+    IntegerSet::IntegerSet(uint64_t* words, std::size_t maxCardinality)
+        : maxCardinality(0), arraySize(0), array(nullptr), ownsArray(false), lowWord(0), highWord(0), windowed(false)
+    {
+        attach(words, maxCardinality);
+    }
+
+    void IntegerSet::attach(uint64_t* words, std::size_t maxCardinality)
+    {
+        if (array && ownsArray) delete[] array;
+        this->maxCardinality = maxCardinality;
+        arraySize = (maxCardinality + 63) / 64;
+        array = words;
+        ownsArray = false;
+        resetWindow();
+    }
+
     void IntegerSet::setMaxCardinality(std::size_t maxCardinality)
     {
         std::size_t arraySize = (maxCardinality + 63) / 64;
@@ -140,24 +912,35 @@ namespace kn
         {
             uint64_t* newArray = new uint64_t[arraySize];
             assert(newArray);
-            for (std::size_t index = 0; index < this->arraySize; index++)
+            std::size_t kept = std::min(arraySize, this->arraySize);
+            for (std::size_t index = 0; index < kept; index++)
             {
                 newArray[index] = array[index];
             }
-            delete[] array;
+            for (std::size_t index = kept; index < arraySize; index++)
+            {
+                newArray[index] = 0;
+            }
+            if (ownsArray) delete[] array;
             array = newArray;
+            ownsArray = true;
             this->arraySize = arraySize;
+            windowed = (arraySize >= WindowWords);
+            lowWord = 0;
+            highWord = arraySize;
         }
         this->maxCardinality = maxCardinality;
         sanitiseHighBits();
+        trim();
     }
 
     void IntegerSet::clear()
     {
-        for (std::size_t index = 0; index < arraySize; index++)
+        for (std::size_t index = lowWord; index < highWord; index++)
         {
             array[index] = 0;
         }
+        resetWindow();
     }
 
     void IntegerSet::fill()
@@ -166,6 +949,8 @@ namespace kn
         {
             array[index] = ~0;
         }
+        lowWord = 0;
+        highWord = arraySize;
 
         sanitiseHighBits();
     }
@@ -173,7 +958,7 @@ namespace kn
     void IntegerSet::fillBefore(std::size_t value)
     {
         std::size_t index = value / 64;
-        for (std::size_t k = 0; k < index; k++)
+        for (std::size_t k = 0; k < std::min(index, arraySize); k++)
         {
             array[k] = ~0;
         }
@@ -181,8 +966,9 @@ namespace kn
         {
             uint64_t mask = singleBit(value % 64) - 1;
             array[index] |= mask;
-            sanitiseHighBits();
         }
+        sanitiseHighBits();
+        widen(0, std::min(index + 1, arraySize));
     }
 
     void IntegerSet::fillAfter(std::size_t value)
@@ -197,13 +983,39 @@ namespace kn
                 array[k] = ~0;
             }
             sanitiseHighBits();
+            widen(index, arraySize);
         }
     }
 
+    void IntegerSet::removeShift(std::size_t value)
+    {
+        assert(value < maxCardinality);
+        std::size_t index = value / 64;
+        std::size_t high = windowed ? highWord : arraySize;
+        if (index >= high) return;
+
+        /// The words between index and the window are zero, and so the shift starts below the window.
+        std::size_t first = index;
+        if (windowed && (lowWord > index + 1)) first = lowWord - 1;
+        if (first == index)
+        {
+            uint64_t keep = singleBit(value % 64) - 1;
+            array[index] = (array[index] & keep) | ((array[index] >> 1) & ~keep);
+        }
+        for (std::size_t k = first + 1; k < high; k++)
+        {
+            array[k - 1] |= array[k] << 63;
+            array[k] >>= 1;
+        }
+        widen(first, high);
+        trim();
+    }
+
     void IntegerSet::copy(const IntegerSet& b)
     {
         assert(maxCardinality == b.maxCardinality);
-        for (std::size_t index = 0; index < arraySize; index++)
+        narrow(b.lowWord, b.highWord);
+        for (std::size_t index = lowWord; index < highWord; index++)
         {
             array[index] = b.array[index];
         }
@@ -211,18 +1023,14 @@ namespace kn
 
     std::size_t IntegerSet::count() const
     {
-        std::size_t sum = 0;
-        for (std::size_t index = 0; index < arraySize; index++)
-        {
-            sum += countBits(array[index]);
-        }
-        return sum;
+        if (lowWord >= highWord) return 0;
+        return kernels->count(array + lowWord, highWord - lowWord);
     }
 
     std::size_t IntegerSet::countLimit(std::size_t limit) const
     {
         std::size_t sum = 0;
-        for (std::size_t index = 0; index < arraySize; index++)
+        for (std::size_t index = lowWord; index < highWord; index++)
         {
             sum += countBits(array[index]);
             if (sum >= limit) break;
@@ -233,31 +1041,23 @@ namespace kn
     std::size_t IntegerSet::countCommon(const IntegerSet& b) const
     {
         assert(maxCardinality == b.maxCardinality);
-        std::size_t sum = 0;
-        for (std::size_t index = 0; index < arraySize; index++)
-        {
-            uint64_t bits = array[index] & b.array[index];
-            sum += countBits(bits);
-        }
-        return sum;
+        if (!windowed) return kernels->countCommon(array, b.array, arraySize);
+        std::size_t low = std::max(lowWord, b.lowWord);
+        std::size_t high = std::min(highWord, b.highWord);
+        if (low >= high) return 0;
+        return kernels->countCommon(array + low, b.array + low, high - low);
     }
 
     std::size_t IntegerSet::countCommonLimit(const IntegerSet& b, std::size_t limit, std::size_t& w) const
     {
         assert(maxCardinality == b.maxCardinality);
-        std::size_t sum = 0;
-        std::size_t theW = maxCardinality;
-        for (std::size_t index = 0; index < arraySize; index++)
-        {
-            uint64_t bits = array[index] & b.array[index];
-            if (bits != 0)
-            {
-                sum += countBits(bits);
-                theW = index * 64 + bitToIndex(lowestBit(bits)); /// any bit will do
-                if (sum >= limit) break;
-            }
-        }
-        w = theW;
+        w = maxCardinality;
+        if (!windowed) return kernels->countCommonLimit(array, b.array, arraySize, limit, w);
+        std::size_t low = std::max(lowWord, b.lowWord);
+        std::size_t high = std::min(highWord, b.highWord);
+        if (low >= high) return 0;
+        std::size_t sum = kernels->countCommonLimit(array + low, b.array + low, high - low, limit, w);
+        if (sum > 0) w += low * 64; /// the kernel reports w within the window
         return sum;
     }
 
@@ -267,46 +1067,262 @@ namespace kn
         {
             array[index] = ~array[index];
         }
+        lowWord = 0;
+        highWord = arraySize;
 
         sanitiseHighBits();
+        trim();
     }
 
     void IntegerSet::intersectWith(const IntegerSet& b)
     {
         assert(maxCardinality == b.maxCardinality);
-        for (std::size_t index = 0; index < arraySize; index++)
+        if (!windowed)
         {
-            array[index] &= b.array[index];
+            kernels->intersection(array, array, b.array, arraySize);
+            return;
         }
+        narrow(std::max(lowWord, b.lowWord), std::min(highWord, b.highWord));
+        if (lowWord >= highWord) return;
+        kernels->intersection(array + lowWord, array + lowWord, b.array + lowWord, highWord - lowWord);
+        trim();
     }
 
     void IntegerSet::unionWith(const IntegerSet& b)
     {
         assert(maxCardinality == b.maxCardinality);
-        for (std::size_t index = 0; index < arraySize; index++)
+        for (std::size_t index = b.lowWord; index < b.highWord; index++)
         {
             array[index] |= b.array[index];
         }
+        widen(b.lowWord, b.highWord);
     }
 
     void IntegerSet::removeAll(const IntegerSet& b)
     {
         assert(maxCardinality == b.maxCardinality);
-        for (std::size_t index = 0; index < arraySize; index++)
+        if (!windowed)
         {
-            array[index] &= ~b.array[index];
+            kernels->difference(array, array, b.array, arraySize);
+            return;
         }
+        std::size_t low = std::max(lowWord, b.lowWord);
+        std::size_t high = std::min(highWord, b.highWord);
+        if (low >= high) return;
+        kernels->difference(array + low, array + low, b.array + low, high - low);
+        trim();
     }
 
     void IntegerSet::intersection(const IntegerSet& a, const IntegerSet& b)
     {
         assert(maxCardinality == a.maxCardinality);
         assert(maxCardinality == b.maxCardinality);
-        for (std::size_t index = 0; index < arraySize; index++)
+        if (!windowed)
         {
-            array[index] = a.array[index] & b.array[index];
+            kernels->intersection(array, a.array, b.array, arraySize);
+            return;
         }
+        narrow(std::max(a.lowWord, b.lowWord), std::min(a.highWord, b.highWord));
+        if (lowWord >= highWord) return;
+        kernels->intersection(array + lowWord, a.array + lowWord, b.array + lowWord, highWord - lowWord);
+        trim();
     }
 
+    std::size_t IntegerSet::intersectionCount(const IntegerSet& a, const IntegerSet& b)
+    {
+        assert(maxCardinality == a.maxCardinality);
+        assert(maxCardinality == b.maxCardinality);
+        if (!windowed) return kernels->intersectionCount(array, a.array, b.array, arraySize);
+        narrow(std::max(a.lowWord, b.lowWord), std::min(a.highWord, b.highWord));
+        if (lowWord >= highWord) return 0;
+        std::size_t count = kernels->intersectionCount(array + lowWord, a.array + lowWord, b.array + lowWord, highWord - lowWord);
+        trim();
+        return count;
+    }
+
+    bool IntegerSet::intersectionAny(const IntegerSet& a, const IntegerSet& b)
+    {
+        assert(maxCardinality == a.maxCardinality);
+        assert(maxCardinality == b.maxCardinality);
+        if (!windowed) return kernels->intersectionAny(array, a.array, b.array, arraySize);
+        narrow(std::max(a.lowWord, b.lowWord), std::min(a.highWord, b.highWord));
+        if (lowWord >= highWord) return false;
+        bool any = kernels->intersectionAny(array + lowWord, a.array + lowWord, b.array + lowWord, highWord - lowWord);
+        if (any) trim(); else highWord = lowWord;
+        return any;
+    }
+
+    bool IntegerSet::intersectWithAny(const IntegerSet& b)
+    {
+        assert(maxCardinality == b.maxCardinality);
+        if (!windowed) return kernels->intersectionAny(array, array, b.array, arraySize);
+        narrow(std::max(lowWord, b.lowWord), std::min(highWord, b.highWord));
+        if (lowWord >= highWord) return false;
+        bool any = kernels->intersectionAny(array + lowWord, array + lowWord, b.array + lowWord, highWord - lowWord);
+        if (any) trim(); else highWord = lowWord;
+        return any;
+    }
+
+    void IntegerSet::countCommonBatch(const IntegerSet* const* rows, std::size_t numRows, std::size_t* counts) const
+    {
+        const uint64_t* words[CountCommonBatchSize];
+        for (std::size_t first = 0; first < numRows; first += CountCommonBatchSize)
+        {
+            std::size_t batch = (numRows - first < CountCommonBatchSize) ? (numRows - first) : CountCommonBatchSize;
+            for (std::size_t r = 0; r < batch; r++)
+            {
+                assert(maxCardinality == rows[first + r]->maxCardinality);
+                words[r] = rows[first + r]->array + lowWord;
+            }
+            if (lowWord < highWord)
+            {
+                kernels->countCommonBatch(array + lowWord, words, batch, highWord - lowWord, counts + first);
+            }
+            else
+            {
+                std::fill(counts + first, counts + first + batch, (std::size_t)0);
+            }
+        }
+    }
+
+    std::size_t IntegerSet::decode(uint32_t* out) const
+    {
+        assert(maxCardinality <= UINT32_MAX);
+        if (lowWord >= highWord) return 0;
+        return kernels->decode(array + lowWord, highWord - lowWord, lowWord * 64, out);
+    }
+
+
+    namespace
+    {
+        const std::size_t SlabAlignment = 64;
+        const std::size_t HugePageSize = 2 * 1024 * 1024;
+
+        uint64_t* allocateAligned(std::size_t bytes)
+        {
+#if defined(_WIN32)
+            return static_cast<uint64_t*>(_aligned_malloc(bytes, SlabAlignment));
+#else
+            void* memory = nullptr;
+            if (posix_memalign(&memory, SlabAlignment, bytes) != 0) return nullptr;
+            return static_cast<uint64_t*>(memory);
+#endif
+        }
+
+        void freeAligned(uint64_t* memory)
+        {
+#if defined(_WIN32)
+            _aligned_free(memory);
+#else
+            free(memory);
+#endif
+        }
+    }
+
+    IntegerSetPool::IntegerSetPool(bool hugePages)
+        : slab(nullptr), capacity(0), mapped(0), hugePages(hugePages), onHugePages(false)
+    {
+    }
+
+    IntegerSetPool::IntegerSetPool(std::size_t count, std::size_t maxCardinality, bool hugePages)
+        : slab(nullptr), capacity(0), mapped(0), hugePages(hugePages), onHugePages(false)
+    {
+        reshape(count, maxCardinality);
+    }
+
+    IntegerSetPool::~IntegerSetPool()
+    {
+        sets.clear();
+        release();
+    }
+
+    IntegerSetPool::IntegerSetPool(IntegerSetPool&& pattern)
+        : slab(nullptr), capacity(0), mapped(0), hugePages(false), onHugePages(false)
+    {
+        *this = std::move(pattern);
+    }
+
+    IntegerSetPool& IntegerSetPool::operator=(IntegerSetPool&& pattern)
+    {
+        if (this != &pattern)
+        {
+            std::swap(slab, pattern.slab);
+            std::swap(capacity, pattern.capacity);
+            std::swap(mapped, pattern.mapped);
+            std::swap(hugePages, pattern.hugePages);
+            std::swap(onHugePages, pattern.onHugePages);
+            std::swap(sets, pattern.sets);
+        }
+        return *this;
+    }
+
+    void IntegerSetPool::release()
+    {
+        if (!slab) return;
+#if defined(KN_HUGE_PAGES)
+        if (mapped) munmap(slab, mapped);
+        else
+#endif
+            freeAligned(slab);
+        slab = nullptr;
+        capacity = 0;
+        mapped = 0;
+        onHugePages = false;
+    }
+
+    void IntegerSetPool::reshape(std::size_t count, std::size_t maxCardinality)
+    {
+        std::size_t words = (maxCardinality + 63) / 64;
+        std::size_t stride = (words + StrideWords - 1) / StrideWords * StrideWords;
+        std::size_t needed = count * stride;
+
+        if (needed > capacity)
+        {
+            release();
+            std::size_t bytes = needed * sizeof(uint64_t);
+#if defined(KN_HUGE_PAGES)
+            if (hugePages)
+            {
+                // Explicitly reserved huge pages are preferred, but are seldom configured; transparent huge
+                // pages are the fallback, and are only a hint.
+                std::size_t rounded = (bytes + HugePageSize - 1) / HugePageSize * HugePageSize;
+                void* memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                if (memory != MAP_FAILED)
+                {
+                    onHugePages = true;
+                }
+                else
+                {
+                    memory = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                    if (memory != MAP_FAILED) madvise(memory, rounded, MADV_HUGEPAGE);
+                }
+                if (memory != MAP_FAILED)
+                {
+                    slab = static_cast<uint64_t*>(memory);
+                    mapped = rounded;
+                }
+            }
+#endif
+            if (!slab)
+            {
+                slab = allocateAligned(bytes > 0 ? bytes : SlabAlignment);
+            }
+            assert(slab);
+            capacity = needed;
+        }
+
+        std::fill(slab, slab + needed, (uint64_t)0);
+
+        if (sets.size() > count) sets.resize(count);
+        for (std::size_t index = 0; index < sets.size(); index++)
+        {
+            sets[index].attach(slab + index * stride, maxCardinality);
+        }
+        sets.reserve(count);
+        for (std::size_t index = sets.size(); index < count; index++)
+        {
+            sets.push_back(IntegerSet(slab + index * stride, maxCardinality));
+        }
+    }
 
 }
@@ -1,415 +1,444 @@
-
 #include <cstdlib>
+#include <deque>
+#include <string>
 #include <CliqueEnumeration.hpp>
+#include <BKSearch.hpp>
 #include <BitStructures.hpp>
 
 namespace kn
 {
-    // Uncomment to enable pretty printing
-    //#define ENABLE_PRETTY_PRINT
 
-    /// The common context for many clique enumerators in the BronKerbosch family.
+    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver)
+    {
+        AllCliques<TomitaPivot>(graph, receiver, CliqueEnumerationOptions());
+    }
 
-    class Context
+    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver)
     {
-    private:
-        IntegerSet* pool;
-        IntegerSet* next;
+        AllCliques<NaudePivot>(graph, receiver, CliqueEnumerationOptions());
+    }
 
-    public:
-        std::size_t numVertices;
-        std::vector<IntegerSet> N;
-        std::vector<IntegerSet> K;
+    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver, unsigned numThreads)
+    {
+        CliqueEnumerationOptions options;
+        options.ordering = BranchOrdering::Index;
+        options.numThreads = numThreads;
+        AllCliques<TomitaPivot>(graph, receiver, options);
+    }
 
-        const Graph* graph;
-        CliqueReceiver* receiver;
+    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver, unsigned numThreads)
+    {
+        CliqueEnumerationOptions options;
+        options.ordering = BranchOrdering::Index;
+        options.numThreads = numThreads;
+        AllCliques<NaudePivot>(graph, receiver, options);
+    }
 
-        Context(const Graph* graph, CliqueReceiver* receiver)
-        {
-            this->graph = graph;
-            this->receiver = receiver;
+    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllCliques<TomitaPivot>(graph, receiver, options);
+    }
 
-            numVertices = graph->countVertices();
-            for (std::size_t ui = 0; ui < numVertices; ui++)
-            {
-                IntegerSet neighbours(numVertices);
-                Graph::Vertex u;
-                Graph::Edge e;
-                graph->getVertexByIndex(ui, u);
-                for (auto it = graph->exitingEdgeIterator(u.id); it.next(e); )
-                {
-                    std::size_t vi = graph->getVertexIndex(e.v);
-                    if (ui != vi) neighbours.add(vi);
-                }
+    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllCliques<NaudePivot>(graph, receiver, options);
+    }
+
+    void AllIndependentSets_Tomita(const Graph* graph, CliqueReceiver* receiver)
+    {
+        AllIndependentSets<TomitaPivot>(graph, receiver, CliqueEnumerationOptions());
+    }
+
+    void AllIndependentSets_Naude(const Graph* graph, CliqueReceiver* receiver)
+    {
+        AllIndependentSets<NaudePivot>(graph, receiver, CliqueEnumerationOptions());
+    }
+
+    void AllIndependentSets_Tomita(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllIndependentSets<TomitaPivot>(graph, receiver, options);
+    }
+
+    void AllIndependentSets_Naude(const Graph* graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllIndependentSets<NaudePivot>(graph, receiver, options);
+    }
+
+    void AllCliques_Tomita(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllCliques<TomitaPivot>(graph, receiver, options);
+    }
 
-                IntegerSet conflicts(neighbours);
-                conflicts.invert();
+    void AllCliques_Naude(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllCliques<NaudePivot>(graph, receiver, options);
+    }
+
+    void AllIndependentSets_Tomita(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllIndependentSets<TomitaPivot>(graph, receiver, options);
+    }
 
-                N.push_back(neighbours);
-                K.push_back(conflicts);
+    void AllIndependentSets_Naude(const CsrGraph& graph, CliqueReceiver* receiver, const CliqueEnumerationOptions& options)
+    {
+        AllIndependentSets<NaudePivot>(graph, receiver, options);
+    }
+
+
+    namespace
+    {
+        void saveList(std::ostream& out, const std::vector<std::size_t>& list)
+        {
+            out << list.size();
+            for (std::size_t v : list)
+            {
+                out << " " << v;
             }
+            out << "\n";
+        }
 
-            this->pool = new IntegerSet[4 * (1+numVertices) + 3];
-            for (std::size_t i = 0; i < 4 * (1+numVertices) + 3; i++)
+        bool loadList(std::istream& in, std::size_t numVertices, std::vector<std::size_t>& list)
+        {
+            std::size_t size;
+            if (!(in >> size) || (size > numVertices)) return false;
+            list.resize(size);
+            for (std::size_t i = 0; i < size; i++)
             {
-                this->pool[i].setMaxCardinality(numVertices);
+                if (!(in >> list[i]) || (list[i] >= numVertices)) return false;
             }
-            this->next = &this->pool[0];
+            return true;
         }
+    }
 
-        ~Context()
+    /**
+    * The checkpoint is written as text: a header line, then the ordering, the number of vertices,
+    * the next top-level branch and the number of frames, and then S, P and X for each frame,
+    * each on a line of its own as a count followed by that many vertex indices.
+    */
+    void CliqueCheckpoint::save(std::ostream& out) const
+    {
+        out << "clique-checkpoint 1\n";
+        out << (int)ordering << " " << numVertices << " " << nextBranch << " " << frames.size() << "\n";
+        for (const CliqueFrame& frame : frames)
         {
-            delete[] this->pool;
+            saveList(out, frame.S);
+            saveList(out, frame.P);
+            saveList(out, frame.X);
         }
+    }
+
+    bool CliqueCheckpoint::load(std::istream& in)
+    {
+        std::string header;
+        int version, order;
+        std::size_t n, next, numFrames;
 
-        IntegerSet* reserveSet()
+        if (!(in >> header >> version) || (header != "clique-checkpoint") || (version != 1)) return false;
+        if (!(in >> order >> n >> next >> numFrames)) return false;
+        if ((order < (int)BranchOrdering::None) || (order > (int)BranchOrdering::Degeneracy) || (next > n)) return false;
+
+        std::vector<CliqueFrame> loaded;
+        for (std::size_t f = 0; f < numFrames; f++)
         {
-            return next++;
+            CliqueFrame frame;
+            if (!loadList(in, n, frame.S) || !loadList(in, n, frame.P) || !loadList(in, n, frame.X)) return false;
+            loaded.push_back(std::move(frame));
         }
 
-        void releaseSet()
+        ordering = (BranchOrdering)order;
+        numVertices = n;
+        nextBranch = next;
+        frames = std::move(loaded);
+        return true;
+    }
+
+
+    void SearchStatistics::accumulate(const SearchStatistics& other)
+    {
+        for (std::size_t d = 0; d < other.levels.size(); d++)
         {
-            next--;
+            Level& level = at(d);
+            const Level& more = other.levels[d];
+            level.calls += more.calls;
+            level.sumCandidates += more.sumCandidates;
+            level.maxCandidates = std::max(level.maxCandidates, more.maxCandidates);
+            level.sumExcluded += more.sumExcluded;
+            level.maxExcluded = std::max(level.maxExcluded, more.maxExcluded);
+            level.wordsScanned += more.wordsScanned;
+            level.inPlace += more.inPlace;
         }
+    }
 
-        IntegerSet* intersect(IntegerSet* a, IntegerSet* b)
+    void SearchStatistics::writeCSV(std::ostream& out) const
+    {
+        out << "depth, calls, sum_p, max_p, sum_x, max_x, words_scanned, in_place\n";
+        for (std::size_t d = 0; d < levels.size(); d++)
         {
-            IntegerSet* r = reserveSet();
-            r->intersection(*a, *b);
-            return r;
+            const Level& level = levels[d];
+            out << d << ", " << level.calls << ", " << level.sumCandidates << ", " << level.maxCandidates << ", "
+                << level.sumExcluded << ", " << level.maxExcluded << ", " << level.wordsScanned << ", " << level.inPlace << "\n";
         }
+    }
 
-        IntegerSet* insert(IntegerSet* a, std::size_t value)
+    void SearchStatistics::writeJSON(std::ostream& out) const
+    {
+        out << "{\n  \"levels\": [";
+        for (std::size_t d = 0; d < levels.size(); d++)
         {
-            IntegerSet* r = reserveSet();
-            r->copy(*a);
-            r->add(value);
-            return r;
+            const Level& level = levels[d];
+            out << ((d == 0) ? "\n" : ",\n");
+            out << "    { \"depth\": " << d << ", \"calls\": " << level.calls
+                << ", \"sum_p\": " << level.sumCandidates << ", \"max_p\": " << level.maxCandidates
+                << ", \"sum_x\": " << level.sumExcluded << ", \"max_x\": " << level.maxExcluded
+                << ", \"words_scanned\": " << level.wordsScanned << ", \"in_place\": " << level.inPlace << " }";
         }
-    };
+        out << "\n  ]\n}\n";
+    }
 
 
-    /// The base class for a BronKerbosch clique enumerator.
-    class BKSearch : public Context
+    /**
+    * Branch and bound for a maximum clique, in the bitset style of San Segundo's BBMC.
+    * The vertices are renumbered so that the densest core (the last to be peeled in a degeneracy
+    * ordering) comes first.  At each node, the candidates are greedily coloured one colour class at
+    * a time, taking the lowest numbered vertex first, and then branched on in reverse colour order.
+    * A branch is cut as soon as the size of the current clique plus the colour of its vertex cannot
+    * exceed the incumbent.  Vertices whose colour is too small to ever matter are not even listed.
+    */
+    class MaximumCliqueSearch
     {
-    public:
-        BKSearch(const Graph* graph, CliqueReceiver* receiver) :
-            Context(graph, receiver) {}
+    private:
+        const Graph* graph;
+        CliqueReceiver* receiver;
+        uint64_t numBranches;
 
-        void enumerateCliques(bool ordered = false)
-        {
-            if (!ordered)
-            {
-                IntegerSet* S = reserveSet();
-                IntegerSet* P = reserveSet();
-                IntegerSet* X = reserveSet();
+        std::size_t numVertices;
+        std::vector<std::size_t> labels; /// the original index of each renumbered vertex
+        std::vector<IntegerSet> N;
 
-                S->clear();
-                P->fill();
-                X->clear();
+        /// Three sets per depth (candidates, uncoloured, colour class), grown as the search deepens.
+        std::deque<IntegerSet> sets;
+        std::deque<std::vector<std::size_t>> vertices;
+        std::deque<std::vector<std::size_t>> colours;
 
-                receiver->reset();
-                receiver->onClear();
-                apply(S, P, X);
-                receiver->onComplete();
+        IntegerSet C;
+        std::size_t cSize;
+        IntegerSet best;
+        std::size_t bestSize;
+
+        std::size_t batchLimit;
+        CliqueBatch batch;
 
-                // consumed by apply: S, P, X
+        IntegerSet& set(std::size_t depth, std::size_t which)
+        {
+            while (sets.size() < 3 * (depth + 1))
+            {
+                sets.push_back(IntegerSet(numVertices));
             }
-            else
+            while (vertices.size() < depth + 1)
             {
-                receiver->reset();
-                receiver->onClear();
-                std::size_t n = graph->countVertices();
+                vertices.push_back(std::vector<std::size_t>());
+                colours.push_back(std::vector<std::size_t>());
+            }
+            return sets[3 * depth + which];
+        }
 
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                bool grouped = (n > 1);
-                if (grouped) receiver->onOpenGroup();
-                bool first = true;
-                Graph::Vertex vertex;
-#endif
+        void improve()
+        {
+            best.copy(C);
+            bestSize = cSize;
 
-                for (std::size_t k = 0; k < n; k++)
+            if (receiver)
+            {
+                IntegerSet clique(std::max<std::size_t>(numVertices, 1));
+                translate(clique);
+                receiver->cliqueCounter++;
+                if (batchLimit)
                 {
-                    IntegerSet* S = reserveSet();
-                    IntegerSet* P = reserveSet();
-                    IntegerSet* X = reserveSet();
-
-                    S->clear();
-                    P->clear();
-                    X->clear();
-
-                    S->add(k);
-                    P->fillBefore(k);
-                    X->fillAfter(k);
-                    P->intersectWith(N[k]);
-                    X->intersectWith(N[k]);
-
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                    if (!first) receiver->onPartition();
-                    first = false;
-                    graph->getVertexByIndex(k, vertex);
-                    receiver->onVertex(k, vertex.attrID);
-#endif
-
-                    apply(S, P, X);
-                    // consumed by apply: S, P, X
+                    auto it = clique.iterator();
+                    while (it.hasNext())
+                    {
+                        batch.vertices.push_back((uint32_t)it.next());
+                    }
+                    batch.offsets.push_back(batch.vertices.size());
+                    if (batch.count() >= batchLimit) flush();
                 }
+                else
+                {
+                    receiver->onClique(*graph, clique);
+                }
+            }
+        }
 
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                if (first) receiver->onCutOff();
-                if (grouped) receiver->onCloseGroup();
-#endif
-                receiver->onComplete();
+        void flush()
+        {
+            if (batch.count() > 0)
+            {
+                receiver->onCliqueBatch(*graph, batch);
+                batch.clear();
             }
         }
-            
-        void apply(IntegerSet* S, IntegerSet* P, IntegerSet* X)
+
+        void colourSort(std::size_t depth, const IntegerSet& P)
         {
-            receiver->recursionCounter++;
-            IntegerSet* Q = pivotConflict(S, P, X);
-            if (Q)
+            IntegerSet& U = set(depth, 1);
+            IntegerSet& Q = set(depth, 2);
+            std::vector<std::size_t>& vs = vertices[depth];
+            std::vector<std::size_t>& cs = colours[depth];
+
+            /// Only a colour of at least kMin can lead to a clique larger than the incumbent.
+            std::size_t kMin = (bestSize >= cSize) ? (bestSize - cSize + 1) : 1;
+            std::size_t k = 0;
+
+            vs.clear();
+            cs.clear();
+            U.copy(P);
+            while (!U.isEmpty())
             {
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                bool grouped = (Q->countLimit(2) > 1);
-                if (grouped) receiver->onOpenGroup();
-                bool first = true;
-                Graph::Vertex vertex;
-#endif
-
-                auto it = Q->iterator();
-                while (it.hasNext())
+                k++;
+                Q.copy(U);
+                std::size_t v = Q.firstElement();
+                while (v < numVertices)
                 {
-                    std::size_t v = it.next();
-                    P->remove(v);
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                    if (!first) receiver->onPartition();
-                    first = false;
-                    graph->getVertexByIndex(v, vertex);
-                    receiver->onVertex(v, vertex.attrID);
-#endif
-
-                    IntegerSet* s2 = this->insert(S, v);
-                    IntegerSet* p2 = this->intersect(P, &N[v]);
-                    IntegerSet* x2 = this->intersect(X, &N[v]);
-
-                    apply(s2, p2, x2);
-
-                    X->add(v);
+                    U.remove(v);
+                    Q.remove(v);
+                    Q.removeAll(N[v]);
+                    if (k >= kMin)
+                    {
+                        vs.push_back(v);
+                        cs.push_back(k);
+                    }
+                    v = Q.firstElement();
                 }
-
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                if (first) receiver->onCutOff();
-                if (grouped) receiver->onCloseGroup();
-#endif
-                this->releaseSet(); // Release Q
-            }
-            else
-            if (X->isEmpty())
-            {
-                /// maximal clique found
-                receiver->cliqueCounter++;
-                receiver->onClique(*graph, *S);
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                receiver->onOk();
-#endif
             }
-            else
-            {
-                /// cut-off: sub-maximal clique
-                receiver->cutOffCounter++;
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                receiver->onCutOff();
-#endif
-            }
-
-            this->releaseSet(); // Release X
-            this->releaseSet(); // Release P
-            this->releaseSet(); // Release S
         }
 
-        virtual IntegerSet* pivotConflict(IntegerSet* S, IntegerSet* P, IntegerSet* X) = 0;
-    };
-
-
-    class BKSearch_Tomita : public BKSearch
-    {
-    public:
-        BKSearch_Tomita(const Graph* graph, CliqueReceiver* receiver) :
-            BKSearch(graph, receiver) {}
-
-        virtual IntegerSet* pivotConflict(IntegerSet* S, IntegerSet* P, IntegerSet* X)
+        void expand(std::size_t depth, IntegerSet& P)
         {
-            if (!P->isEmpty())
+            numBranches++;
+            colourSort(depth, P);
+
+            std::vector<std::size_t>& vs = vertices[depth];
+            std::vector<std::size_t>& cs = colours[depth];
+            for (std::size_t i = vs.size(); i > 0; i--)
             {
-                std::size_t most = 0;
-                std::size_t q = 0;
+                if (cSize + cs[i - 1] <= bestSize) return;
 
-                auto it = X->iterator();
-                while (it.hasNext())
+                std::size_t v = vs[i - 1];
+                C.add(v);
+                cSize++;
+
+                IntegerSet& P2 = set(depth + 1, 0);
+                if (!P2.intersectionAny(P, N[v]))
                 {
-                    std::size_t v = it.next();
-                    std::size_t count = P->countCommon(N[v]) + 1;
-                    if (count > most)
-                    {
-                        most = count;
-                        q = v;
-                    }
+                    if (cSize > bestSize) improve();
                 }
-
-                auto it2 = P->iterator();
-                while (it2.hasNext())
+                else
                 {
-                    std::size_t v = it2.next();
-                    std::size_t count = P->countCommon(N[v]) + 1;
-                    if (count > most)
-                    {
-                        most = count;
-                        q = v;
-                    }
+                    expand(depth + 1, P2);
                 }
 
-                IntegerSet* Q = this->intersect(P, &K[q]);
-
-                return Q;
-            }
-            else
-            {
-                return nullptr;
+                C.remove(v);
+                cSize--;
+                P.remove(v);
             }
         }
-    };
 
-    class BKSearch_Naude : public BKSearch
-    {
     public:
-        BKSearch_Naude(const Graph* graph, CliqueReceiver* receiver) :
-            BKSearch(graph, receiver) {}
-
-        virtual IntegerSet* pivotConflict(IntegerSet* S, IntegerSet* P, IntegerSet* X)
+        MaximumCliqueSearch(const Graph* graph, CliqueReceiver* receiver)
         {
-        search:
-            std::size_t q = numVertices; // an initial value which is not a valid vertex
-            std::size_t least = numVertices + 1; // not infinity, but large enough
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-            Graph::Vertex vertex;
-#endif
-
-            if (!X->isEmpty())
+            this->graph = graph;
+            this->receiver = receiver;
+            numBranches = 0;
+
+            Adjacency adjacency(graph);
+            numVertices = adjacency.numVertices;
+
+            labels = degeneracyOrder(adjacency);
+            std::reverse(labels.begin(), labels.end());
+            std::vector<std::size_t> position(numVertices);
+            for (std::size_t i = 0; i < numVertices; i++)
             {
-                auto it = X->iterator();
+                position[labels[i]] = i;
+            }
+
+            for (std::size_t i = 0; i < numVertices; i++)
+            {
+                IntegerSet neighbours(numVertices);
+                auto it = adjacency.N[labels[i]].iterator();
                 while (it.hasNext())
                 {
-                    std::size_t v = it.next();
-                    std::size_t w = 0;
-                    std::size_t count = P->countCommonLimit(K[v], least, w);
-                    if (count < least)
-                    {
-                        if (count <= 2)
-                        {
-                            if (count != 1) // count in { 0, 2 }
-                            {
-                                q = v;
-                                goto conclude;
-                            }
-                            else
-                            {
-                                /// Process w in place
-                                S->add(w);
-                                P->intersectWith(N[w]);
-                                X->intersectWith(N[w]);
-
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                                graph->getVertexByIndex(w, vertex);
-                                receiver->onVertex(w, vertex.attrID);
-#endif
-
-                                /// Very important!
-                                /// We are iterating through X, and we have potentially just modified X.
-                                /// It is essential that the iterator be written to allow concurrent updates.
-                                /// If your iterator does not allow concurrent updates, then just "goto search".
-
-                                if (K[w].contains(q)) goto search;
-                            }
-                        }
-                        else
-                        {
-                            q = v;
-                            least = count;
-                        }
-                    }
+                    neighbours.add(position[it.next()]);
                 }
+                N.push_back(std::move(neighbours));
             }
 
-            if (!P->isEmpty())
+            std::size_t cardinality = std::max<std::size_t>(numVertices, 1);
+            C.setMaxCardinality(cardinality);
+            best.setMaxCardinality(cardinality);
+            C.clear();
+            best.clear();
+            cSize = 0;
+            bestSize = 0;
+            batchLimit = 0;
+        }
+
+        std::size_t search()
+        {
+            if (receiver)
             {
-                auto it = P->iterator();
-                while (it.hasNext())
+                receiver->reset();
+                receiver->onClear();
+                batchLimit = receiver->batchSize();
+            }
+
+            if (numVertices > 0)
+            {
+                /// A greedy clique over the renumbered vertices gives the first incumbent.
+                IntegerSet& P = set(0, 0);
+                P.fill();
+                for (std::size_t v = P.firstElement(); v < numVertices; v = P.firstElement())
                 {
-                    std::size_t v = it.next();
-                    std::size_t w = 0;
-                    std::size_t count = P->countCommonLimit(K[v], least, w);
-                    if (count < least)
-                    {
-                        if (count <= 2)
-                        {
-                            if (count != 1) // count in { 0, 2 }
-                            {
-                                q = v;
-                                goto conclude;
-                            }
-                            else
-                            {
-                                /// Process v in place
-                                S->add(v);
-                                P->intersectWith(N[v]);
-                                X->intersectWith(N[v]);
-
-#if !defined(NDEBUG) && defined(ENABLE_PRETTY_PRINT)
-                                graph->getVertexByIndex(v, vertex);
-                                receiver->onVertex(v, vertex.attrID);
-#endif
-
-                                /// Very important!
-                                /// We are iterating through P, and we have potentially just modified P.
-                                /// It is essential that the iterator be written to allow concurrent updates.
-                                /// If your iterator does not allow concurrent updates, then just "goto search".
-
-                                if (K[v].contains(q)) goto search;
-                            }
-                        }
-                        else
-                        {
-                            q = v;
-                            least = count;
-                        }
-                    }
+                    C.add(v);
+                    cSize++;
+                    P.intersectWith(N[v]);
                 }
+                improve();
+                C.clear();
+                cSize = 0;
+
+                P.fill();
+                expand(0, P);
             }
 
-        conclude:
-            if (q < numVertices)
+            if (receiver)
             {
-                IntegerSet* Q = this->intersect(P, &K[q]);
-                return Q;
+                receiver->recursionCounter += numBranches;
+                flush();
+                receiver->onComplete();
             }
-            else
-                return nullptr;
+            return bestSize;
         }
-    };
-
 
-    void AllCliques_Tomita(const Graph* graph, CliqueReceiver* receiver)
-    {
-        BKSearch_Tomita alg(graph, receiver);
-
-        alg.enumerateCliques();
-    }
+        /// Writes the incumbent into clique, in terms of the original vertex indices.
+        void translate(IntegerSet& clique) const
+        {
+            clique.clear();
+            auto it = best.iterator();
+            while (it.hasNext())
+            {
+                clique.add(labels[it.next()]);
+            }
+        }
+    };
 
-    void AllCliques_Naude(const Graph* graph, CliqueReceiver* receiver)
+    std::size_t MaximumClique(const Graph* graph, IntegerSet& clique, CliqueReceiver* receiver)
     {
-        BKSearch_Naude alg(graph, receiver);
+        MaximumCliqueSearch alg(graph, receiver);
 
-        alg.enumerateCliques();
+        std::size_t size = alg.search();
+        clique.setMaxCardinality(std::max<std::size_t>(graph->countVertices(), 1));
+        alg.translate(clique);
+        return size;
     }
 
 }
@@ -0,0 +1,702 @@
+
+#include <CompressedIntegerSet.hpp>
+#include <iterator>
+
+namespace kn
+{
+
+    const std::size_t CompressedIntegerSet::ChunkSize;
+    const std::size_t CompressedIntegerSet::ChunkWords;
+    const std::size_t CompressedIntegerSet::ArrayLimit;
+
+    namespace
+    {
+        const std::size_t ChunkSize = CompressedIntegerSet::ChunkSize;
+        const std::size_t ChunkWords = CompressedIntegerSet::ChunkWords;
+        const std::size_t ArrayLimit = CompressedIntegerSet::ArrayLimit;
+
+        /// An array chunk which is this many times smaller than another is probed into it by binary
+        /// search, rather than merged with it.
+        const std::size_t GallopRatio = 32;
+
+        bool testBit(const std::vector<uint64_t>& bits, std::size_t offset)
+        {
+            return (bits[offset / 64] & singleBit(offset % 64)) != 0;
+        }
+
+        std::size_t countWords(const uint64_t* bits, std::size_t n)
+        {
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < n; i++)
+            {
+                sum += countBits(bits[i]);
+            }
+            return sum;
+        }
+
+        /// The number of words of a bit vector of arraySize words lying within the chunk of the given key.
+        std::size_t wordsWithin(std::size_t key, std::size_t arraySize)
+        {
+            std::size_t from = key * ChunkWords;
+            if (from >= arraySize) return 0;
+            return (arraySize - from < ChunkWords) ? (arraySize - from) : ChunkWords;
+        }
+    }
+
+    struct CompressedIntegerSet::ChunkOperations
+    {
+        static Chunk make(std::size_t key)
+        {
+            Chunk chunk;
+            chunk.key = key;
+            chunk.cardinality = 0;
+            return chunk;
+        }
+
+        static void toBitmap(Chunk& chunk)
+        {
+            chunk.bits.assign(ChunkWords, 0);
+            for (uint16_t offset : chunk.values)
+            {
+                chunk.bits[offset / 64] |= singleBit(offset % 64);
+            }
+            std::vector<uint16_t>().swap(chunk.values);
+        }
+
+        static void toArray(Chunk& chunk)
+        {
+            std::vector<uint16_t> values;
+            values.reserve(chunk.cardinality);
+            for (std::size_t index = 0; index < ChunkWords; index++)
+            {
+                uint64_t bits = chunk.bits[index];
+                while (bits != 0)
+                {
+                    uint64_t bit = lowestBit(bits);
+                    bits ^= bit;
+                    values.push_back((uint16_t)(index * 64 + bitToIndex(bit)));
+                }
+            }
+            chunk.values.swap(values);
+            std::vector<uint64_t>().swap(chunk.bits);
+        }
+
+        /// Chooses the representation which suits the cardinality of the chunk.
+        static void settle(Chunk& chunk)
+        {
+            if (chunk.isBitmap())
+            {
+                if (chunk.cardinality <= ArrayLimit) toArray(chunk);
+            }
+            else if (chunk.cardinality > ArrayLimit)
+            {
+                toBitmap(chunk);
+            }
+        }
+
+        static bool contains(const Chunk& chunk, uint16_t offset)
+        {
+            if (chunk.isBitmap())
+                return testBit(chunk.bits, offset);
+            else
+                return std::binary_search(chunk.values.begin(), chunk.values.end(), offset);
+        }
+
+        /// Writes the offsets common to two arrays into r, or merely counts them when r is null.
+        static std::size_t intersectArrays(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b, std::vector<uint16_t>* r)
+        {
+            const std::vector<uint16_t>& small = (a.size() <= b.size()) ? a : b;
+            const std::vector<uint16_t>& large = (a.size() <= b.size()) ? b : a;
+            std::size_t sum = 0;
+
+            if (small.size() * GallopRatio < large.size())
+            {
+                auto from = large.begin();
+                for (uint16_t offset : small)
+                {
+                    from = std::lower_bound(from, large.end(), offset);
+                    if (from == large.end()) break;
+                    if (*from == offset)
+                    {
+                        if (r) r->push_back(offset);
+                        sum++;
+                    }
+                }
+            }
+            else
+            {
+                std::size_t i = 0;
+                std::size_t j = 0;
+                while ((i < a.size()) && (j < b.size()))
+                {
+                    if (a[i] < b[j]) i++;
+                    else if (b[j] < a[i]) j++;
+                    else
+                    {
+                        if (r) r->push_back(a[i]);
+                        sum++;
+                        i++;
+                        j++;
+                    }
+                }
+            }
+            return sum;
+        }
+
+        static std::size_t countCommon(const Chunk& a, const Chunk& b)
+        {
+            if (a.isBitmap() && b.isBitmap())
+            {
+                std::size_t sum = 0;
+                for (std::size_t index = 0; index < ChunkWords; index++)
+                {
+                    sum += countBits(a.bits[index] & b.bits[index]);
+                }
+                return sum;
+            }
+            else if (a.isBitmap() || b.isBitmap())
+            {
+                const Chunk& bitmap = a.isBitmap() ? a : b;
+                const Chunk& array = a.isBitmap() ? b : a;
+                std::size_t sum = 0;
+                for (uint16_t offset : array.values)
+                {
+                    sum += testBit(bitmap.bits, offset);
+                }
+                return sum;
+            }
+            else
+                return intersectArrays(a.values, b.values, nullptr);
+        }
+
+        static Chunk intersection(const Chunk& a, const Chunk& b)
+        {
+            Chunk r = make(a.key);
+            if (a.isBitmap() && b.isBitmap())
+            {
+                r.bits.resize(ChunkWords);
+                for (std::size_t index = 0; index < ChunkWords; index++)
+                {
+                    r.bits[index] = a.bits[index] & b.bits[index];
+                }
+                r.cardinality = countWords(r.bits.data(), ChunkWords);
+                settle(r);
+            }
+            else if (a.isBitmap() || b.isBitmap())
+            {
+                const Chunk& bitmap = a.isBitmap() ? a : b;
+                const Chunk& array = a.isBitmap() ? b : a;
+                for (uint16_t offset : array.values)
+                {
+                    if (testBit(bitmap.bits, offset)) r.values.push_back(offset);
+                }
+                r.cardinality = r.values.size();
+            }
+            else
+            {
+                r.cardinality = intersectArrays(a.values, b.values, &r.values);
+            }
+            return r;
+        }
+
+        static void unionWith(Chunk& a, const Chunk& b)
+        {
+            if (!a.isBitmap() && !b.isBitmap())
+            {
+                std::vector<uint16_t> values;
+                values.reserve(a.values.size() + b.values.size());
+                std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(values));
+                a.values.swap(values);
+                a.cardinality = a.values.size();
+                settle(a);
+                return;
+            }
+
+            if (!a.isBitmap()) toBitmap(a);
+            if (b.isBitmap())
+            {
+                for (std::size_t index = 0; index < ChunkWords; index++)
+                {
+                    a.bits[index] |= b.bits[index];
+                }
+            }
+            else
+            {
+                for (uint16_t offset : b.values)
+                {
+                    a.bits[offset / 64] |= singleBit(offset % 64);
+                }
+            }
+            a.cardinality = countWords(a.bits.data(), ChunkWords);
+        }
+
+        static void removeAll(Chunk& a, const Chunk& b)
+        {
+            if (a.isBitmap())
+            {
+                if (b.isBitmap())
+                {
+                    for (std::size_t index = 0; index < ChunkWords; index++)
+                    {
+                        a.bits[index] &= ~b.bits[index];
+                    }
+                }
+                else
+                {
+                    for (uint16_t offset : b.values)
+                    {
+                        a.bits[offset / 64] &= ~singleBit(offset % 64);
+                    }
+                }
+                a.cardinality = countWords(a.bits.data(), ChunkWords);
+                settle(a);
+            }
+            else
+            {
+                std::size_t kept = 0;
+                for (uint16_t offset : a.values)
+                {
+                    if (!contains(b, offset)) a.values[kept++] = offset;
+                }
+                a.values.resize(kept);
+                a.cardinality = kept;
+            }
+        }
+
+        /// As the operations above, where b is the n words of a bit vector lying within the chunk.
+
+        static std::size_t countCommon(const Chunk& a, const uint64_t* b, std::size_t n)
+        {
+            std::size_t sum = 0;
+            if (a.isBitmap())
+            {
+                for (std::size_t index = 0; index < n; index++)
+                {
+                    sum += countBits(a.bits[index] & b[index]);
+                }
+            }
+            else
+            {
+                for (uint16_t offset : a.values)
+                {
+                    if ((std::size_t)(offset / 64) >= n) break;
+                    sum += ((b[offset / 64] & singleBit(offset % 64)) != 0);
+                }
+            }
+            return sum;
+        }
+
+        static void intersectWith(Chunk& a, const uint64_t* b, std::size_t n)
+        {
+            if (a.isBitmap())
+            {
+                for (std::size_t index = 0; index < ChunkWords; index++)
+                {
+                    a.bits[index] &= (index < n) ? b[index] : 0;
+                }
+                a.cardinality = countWords(a.bits.data(), ChunkWords);
+                settle(a);
+            }
+            else
+            {
+                std::size_t kept = 0;
+                for (uint16_t offset : a.values)
+                {
+                    if ((std::size_t)(offset / 64) >= n) break;
+                    if ((b[offset / 64] & singleBit(offset % 64)) != 0) a.values[kept++] = offset;
+                }
+                a.values.resize(kept);
+                a.cardinality = kept;
+            }
+        }
+
+        static void removeAll(Chunk& a, const uint64_t* b, std::size_t n)
+        {
+            if (a.isBitmap())
+            {
+                for (std::size_t index = 0; index < n; index++)
+                {
+                    a.bits[index] &= ~b[index];
+                }
+                a.cardinality = countWords(a.bits.data(), ChunkWords);
+                settle(a);
+            }
+            else
+            {
+                std::size_t kept = 0;
+                for (uint16_t offset : a.values)
+                {
+                    bool present = ((std::size_t)(offset / 64) < n) && ((b[offset / 64] & singleBit(offset % 64)) != 0);
+                    if (!present) a.values[kept++] = offset;
+                }
+                a.values.resize(kept);
+                a.cardinality = kept;
+            }
+        }
+    };
+
+
+    CompressedIntegerSet::CompressedIntegerSet()
+    {
+        maxCardinality = 1;
+    }
+
+    CompressedIntegerSet::CompressedIntegerSet(std::size_t maxCardinality)
+    {
+        this->maxCardinality = maxCardinality;
+    }
+
+    std::vector<CompressedIntegerSet::Chunk>::iterator CompressedIntegerSet::locate(std::size_t key)
+    {
+        return std::lower_bound(chunks.begin(), chunks.end(), key,
+            [](const Chunk& chunk, std::size_t key) { return chunk.key < key; });
+    }
+
+    std::vector<CompressedIntegerSet::Chunk>::const_iterator CompressedIntegerSet::locate(std::size_t key) const
+    {
+        return std::lower_bound(chunks.begin(), chunks.end(), key,
+            [](const Chunk& chunk, std::size_t key) { return chunk.key < key; });
+    }
+
+    void CompressedIntegerSet::setMaxCardinality(std::size_t maxCardinality)
+    {
+        if (maxCardinality < this->maxCardinality)
+        {
+            std::size_t key = maxCardinality / ChunkSize;
+            auto it = locate(key);
+            if ((it != chunks.end()) && (it->key == key))
+            {
+                IntegerSet mask(ChunkSize);
+                mask.fillBefore(maxCardinality % ChunkSize);
+                ChunkOperations::intersectWith(*it, mask.array, mask.arraySize);
+                if (it->cardinality != 0) it++;
+            }
+            chunks.erase(it, chunks.end());
+        }
+        this->maxCardinality = maxCardinality;
+    }
+
+    void CompressedIntegerSet::add(std::size_t value)
+    {
+        assert(value < maxCardinality);
+
+        std::size_t key = value / ChunkSize;
+        uint16_t offset = (uint16_t)(value % ChunkSize);
+        auto it = locate(key);
+        if ((it == chunks.end()) || (it->key != key))
+        {
+            it = chunks.insert(it, ChunkOperations::make(key));
+        }
+
+        if (it->isBitmap())
+        {
+            uint64_t bit = singleBit(offset % 64);
+            if ((it->bits[offset / 64] & bit) == 0)
+            {
+                it->bits[offset / 64] |= bit;
+                it->cardinality++;
+            }
+        }
+        else
+        {
+            auto at = std::lower_bound(it->values.begin(), it->values.end(), offset);
+            if ((at == it->values.end()) || (*at != offset))
+            {
+                it->values.insert(at, offset);
+                it->cardinality++;
+                ChunkOperations::settle(*it);
+            }
+        }
+    }
+
+    void CompressedIntegerSet::remove(std::size_t value)
+    {
+        assert(value < maxCardinality);
+
+        std::size_t key = value / ChunkSize;
+        uint16_t offset = (uint16_t)(value % ChunkSize);
+        auto it = locate(key);
+        if ((it == chunks.end()) || (it->key != key)) return;
+
+        if (it->isBitmap())
+        {
+            uint64_t bit = singleBit(offset % 64);
+            if ((it->bits[offset / 64] & bit) != 0)
+            {
+                it->bits[offset / 64] &= ~bit;
+                it->cardinality--;
+                ChunkOperations::settle(*it);
+            }
+        }
+        else
+        {
+            auto at = std::lower_bound(it->values.begin(), it->values.end(), offset);
+            if ((at != it->values.end()) && (*at == offset))
+            {
+                it->values.erase(at);
+                it->cardinality--;
+            }
+        }
+
+        if (it->cardinality == 0) chunks.erase(it);
+    }
+
+    bool CompressedIntegerSet::contains(std::size_t value) const
+    {
+        if (value >= maxCardinality) return false;
+
+        std::size_t key = value / ChunkSize;
+        auto it = locate(key);
+        return (it != chunks.end()) && (it->key == key) && ChunkOperations::contains(*it, (uint16_t)(value % ChunkSize));
+    }
+
+    std::size_t CompressedIntegerSet::firstElement() const
+    {
+        if (chunks.empty()) return maxCardinality;
+
+        const Chunk& chunk = chunks.front();
+        std::size_t base = chunk.key * ChunkSize;
+        if (chunk.isBitmap())
+        {
+            std::size_t index = 0;
+            while (chunk.bits[index] == 0) index++;
+            return base + index * 64 + lowestBitIndex(chunk.bits[index]);
+        }
+        else
+            return base + chunk.values.front();
+    }
+
+    std::size_t CompressedIntegerSet::lastElement() const
+    {
+        if (chunks.empty()) return maxCardinality;
+
+        const Chunk& chunk = chunks.back();
+        std::size_t base = chunk.key * ChunkSize;
+        if (chunk.isBitmap())
+        {
+            std::size_t index = ChunkWords - 1;
+            while (chunk.bits[index] == 0) index--;
+            return base + index * 64 + highestBitIndex(chunk.bits[index]);
+        }
+        else
+            return base + chunk.values.back();
+    }
+
+    std::size_t CompressedIntegerSet::count() const
+    {
+        std::size_t sum = 0;
+        for (const Chunk& chunk : chunks)
+        {
+            sum += chunk.cardinality;
+        }
+        return sum;
+    }
+
+    std::size_t CompressedIntegerSet::countCommon(const CompressedIntegerSet& b) const
+    {
+        std::size_t sum = 0;
+        auto i = chunks.begin();
+        auto j = b.chunks.begin();
+        while ((i != chunks.end()) && (j != b.chunks.end()))
+        {
+            if (i->key < j->key) i++;
+            else if (j->key < i->key) j++;
+            else
+            {
+                sum += ChunkOperations::countCommon(*i, *j);
+                i++;
+                j++;
+            }
+        }
+        return sum;
+    }
+
+    void CompressedIntegerSet::intersectWith(const CompressedIntegerSet& b)
+    {
+        intersection(*this, b);
+    }
+
+    void CompressedIntegerSet::unionWith(const CompressedIntegerSet& b)
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        std::vector<Chunk> result;
+        result.reserve(chunks.size() + b.chunks.size());
+        auto i = chunks.begin();
+        auto j = b.chunks.begin();
+        while ((i != chunks.end()) || (j != b.chunks.end()))
+        {
+            if ((j == b.chunks.end()) || ((i != chunks.end()) && (i->key < j->key)))
+            {
+                result.push_back(std::move(*i++));
+            }
+            else if ((i == chunks.end()) || (j->key < i->key))
+            {
+                result.push_back(*j++);
+            }
+            else
+            {
+                ChunkOperations::unionWith(*i, *j);
+                result.push_back(std::move(*i++));
+                j++;
+            }
+        }
+        chunks.swap(result);
+    }
+
+    void CompressedIntegerSet::removeAll(const CompressedIntegerSet& b)
+    {
+        std::size_t kept = 0;
+        auto j = b.chunks.begin();
+        for (std::size_t k = 0; k < chunks.size(); k++)
+        {
+            Chunk& chunk = chunks[k];
+            while ((j != b.chunks.end()) && (j->key < chunk.key)) j++;
+            if ((j != b.chunks.end()) && (j->key == chunk.key))
+            {
+                ChunkOperations::removeAll(chunk, *j);
+            }
+            if (chunk.cardinality != 0)
+            {
+                if (kept != k) chunks[kept] = std::move(chunk);
+                kept++;
+            }
+        }
+        chunks.resize(kept);
+    }
+
+    void CompressedIntegerSet::intersection(const CompressedIntegerSet& a, const CompressedIntegerSet& b)
+    {
+        assert((maxCardinality == a.maxCardinality) && (maxCardinality == b.maxCardinality));
+
+        std::vector<Chunk> result;
+        auto i = a.chunks.begin();
+        auto j = b.chunks.begin();
+        while ((i != a.chunks.end()) && (j != b.chunks.end()))
+        {
+            if (i->key < j->key) i++;
+            else if (j->key < i->key) j++;
+            else
+            {
+                Chunk chunk = ChunkOperations::intersection(*i, *j);
+                if (chunk.cardinality != 0) result.push_back(std::move(chunk));
+                i++;
+                j++;
+            }
+        }
+        chunks.swap(result);
+    }
+
+    std::size_t CompressedIntegerSet::countCommon(const IntegerSet& b) const
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        std::size_t sum = 0;
+        for (const Chunk& chunk : chunks)
+        {
+            sum += ChunkOperations::countCommon(chunk, b.array + chunk.key * ChunkWords, wordsWithin(chunk.key, b.arraySize));
+        }
+        return sum;
+    }
+
+    void CompressedIntegerSet::intersectWith(const IntegerSet& b)
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        std::size_t kept = 0;
+        for (std::size_t k = 0; k < chunks.size(); k++)
+        {
+            Chunk& chunk = chunks[k];
+            ChunkOperations::intersectWith(chunk, b.array + chunk.key * ChunkWords, wordsWithin(chunk.key, b.arraySize));
+            if (chunk.cardinality != 0)
+            {
+                if (kept != k) chunks[kept] = std::move(chunk);
+                kept++;
+            }
+        }
+        chunks.resize(kept);
+    }
+
+    void CompressedIntegerSet::removeAll(const IntegerSet& b)
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        std::size_t kept = 0;
+        for (std::size_t k = 0; k < chunks.size(); k++)
+        {
+            Chunk& chunk = chunks[k];
+            ChunkOperations::removeAll(chunk, b.array + chunk.key * ChunkWords, wordsWithin(chunk.key, b.arraySize));
+            if (chunk.cardinality != 0)
+            {
+                if (kept != k) chunks[kept] = std::move(chunk);
+                kept++;
+            }
+        }
+        chunks.resize(kept);
+    }
+
+    void CompressedIntegerSet::intersection(const CompressedIntegerSet& a, const IntegerSet& b)
+    {
+        if (this != &a) *this = a;
+        intersectWith(b);
+    }
+
+    void CompressedIntegerSet::copy(const IntegerSet& b)
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        chunks.clear();
+        for (std::size_t key = b.lowWord / ChunkWords; key * ChunkWords < b.highWord; key++)
+        {
+            const uint64_t* words = b.array + key * ChunkWords;
+            std::size_t n = wordsWithin(key, b.arraySize);
+            std::size_t cardinality = countWords(words, n);
+            if (cardinality == 0) continue;
+
+            Chunk chunk = ChunkOperations::make(key);
+            chunk.cardinality = cardinality;
+            chunk.bits.assign(ChunkWords, 0);
+            std::copy(words, words + n, chunk.bits.begin());
+            ChunkOperations::settle(chunk);
+            chunks.push_back(std::move(chunk));
+        }
+    }
+
+    void CompressedIntegerSet::copyTo(IntegerSet& b) const
+    {
+        assert(maxCardinality == b.maxCardinality);
+
+        b.clear();
+        for (const Chunk& chunk : chunks)
+        {
+            uint64_t* words = b.array + chunk.key * ChunkWords;
+            if (chunk.isBitmap())
+            {
+                std::copy(chunk.bits.begin(), chunk.bits.begin() + wordsWithin(chunk.key, b.arraySize), words);
+            }
+            else
+            {
+                for (uint16_t offset : chunk.values)
+                {
+                    words[offset / 64] |= singleBit(offset % 64);
+                }
+            }
+        }
+        if (!chunks.empty())
+        {
+            b.widen(chunks.front().key * ChunkWords, std::min(b.arraySize, (chunks.back().key + 1) * ChunkWords));
+            b.trim();
+        }
+    }
+
+    std::size_t CompressedIntegerSet::memoryUsage() const
+    {
+        std::size_t bytes = sizeof(*this) + chunks.capacity() * sizeof(Chunk);
+        for (const Chunk& chunk : chunks)
+        {
+            bytes += chunk.values.capacity() * sizeof(uint16_t) + chunk.bits.capacity() * sizeof(uint64_t);
+        }
+        return bytes;
+    }
+
+}
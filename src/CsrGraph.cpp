@@ -0,0 +1,115 @@
+
+#include <stdexcept>
+#include <utility>
+#include <CsrGraph.hpp>
+
+namespace kn
+{
+
+    CsrGraph::CsrGraph(const Graph& graph)
+    {
+        this->graph = &graph;
+        vertexAttributeModel = graph.getVertexAttributeModel();
+        edgeAttributeModel = graph.getEdgeAttributeModel();
+
+        readVertices();
+        outOffsets.reserve(numVertices + 1);
+        outOffsets.push_back(0);
+
+        /// Each list of exiting arcs is gathered and sorted in turn.
+        std::vector<std::pair<uint32_t, AttrID>> arcs;
+        for (std::size_t ui = 0; ui < numVertices; ui++)
+        {
+            Graph::Edge e;
+            arcs.clear();
+            for (auto it = graph.exitingEdgeIterator(vertexIDs[ui]); it.next(e); )
+            {
+                arcs.push_back(std::make_pair((uint32_t)graph.getVertexIndex(e.v), e.attrID));
+            }
+            std::sort(arcs.begin(), arcs.end());
+            for (const auto& arc : arcs)
+            {
+                outTargets.push_back(arc.first);
+                outAttributes.push_back(arc.second);
+            }
+            outOffsets.push_back(outTargets.size());
+        }
+
+        transpose();
+    }
+
+    CsrGraph::CsrGraph(const Graph& graph, std::vector<std::size_t>&& outOffsets, std::vector<uint32_t>&& outTargets, std::vector<AttrID>&& outAttributes)
+        : outOffsets(std::move(outOffsets)), outTargets(std::move(outTargets)), outAttributes(std::move(outAttributes))
+    {
+        this->graph = &graph;
+        vertexAttributeModel = graph.getVertexAttributeModel();
+        edgeAttributeModel = graph.getEdgeAttributeModel();
+
+        readVertices();
+        transpose();
+    }
+
+    void CsrGraph::readVertices()
+    {
+        numVertices = graph->countVertices();
+        if (numVertices > 0xFFFFFFFFULL)
+            throw std::length_error("CsrGraph is limited to 2^32 vertices");
+
+        vertexIDs.resize(numVertices);
+        vertexAttributes.resize(numVertices);
+        for (std::size_t ui = 0; ui < numVertices; ui++)
+        {
+            Graph::Vertex u;
+            graph->getVertexByIndex(ui, u);
+            vertexIDs[ui] = u.id;
+            vertexAttributes[ui] = u.attrID;
+        }
+    }
+
+    /// Every arc enters exactly one vertex, so the entering lists are the exiting lists transposed.
+    /// The sources are visited in increasing order, and so each entering list comes out sorted.
+    void CsrGraph::transpose()
+    {
+        inOffsets.assign(numVertices + 1, 0);
+        for (uint32_t vi : outTargets)
+        {
+            inOffsets[vi + 1]++;
+        }
+        for (std::size_t vi = 0; vi < numVertices; vi++)
+        {
+            inOffsets[vi + 1] += inOffsets[vi];
+        }
+        inSources.resize(outTargets.size());
+        inAttributes.resize(outTargets.size());
+        std::vector<std::size_t> fill(inOffsets.begin(), inOffsets.end() - 1);
+        for (std::size_t ui = 0; ui < numVertices; ui++)
+        {
+            for (std::size_t t = outOffsets[ui]; t < outOffsets[ui + 1]; t++)
+            {
+                std::size_t s = fill[outTargets[t]]++;
+                inSources[s] = (uint32_t)ui;
+                inAttributes[s] = outAttributes[t];
+            }
+        }
+    }
+
+    std::unique_ptr<IntegerSetPool> CsrGraph::adjacency(bool hugePages) const
+    {
+        std::unique_ptr<IntegerSetPool> matrix(new IntegerSetPool(numVertices, numVertices, hugePages));
+        for (std::size_t u = 0; u < numVertices; u++)
+        {
+            IntegerSet& row = (*matrix)[u];
+            for (uint32_t v : exitingTargets(u))
+            {
+                row.add(v);
+            }
+        }
+        return matrix;
+    }
+
+    CsrGraph Graph::freeze() const
+    {
+        return CsrGraph(*this);
+    }
+
+}
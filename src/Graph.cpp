@@ -1,4 +1,7 @@
 
+#include <numeric>
+#include <thread>
+#include <unordered_set>
 #include <Graph.hpp>
 
 namespace kn
@@ -22,105 +25,186 @@ namespace kn
 
     Graph::Graph(const Graph& other, bool complement)
     {
+        if (complement)
+            copyComplement(other);
+        else
+            copyFrom(other);
+    }
+
+    Graph::Graph(const Graph& other, const std::vector<VertexID>& permutation, bool reassignAttributes)
+    {
+        copyPermuted(other, permutation, reassignAttributes);
+    }
+
+    /// Each exiting list of other is walked from its tail, and each arc is linked in at the head of
+    /// the list here, so that the exiting lists come out in the same order.
+    void Graph::copyFrom(const Graph& other)
+    {
+        vertexAttributes = other.vertexAttributes;
+        edgeAttributes = other.edgeAttributes;
+
+        std::size_t numArcs = 0;
+        vertices = other.vertices;
+        for (VertexInfo& u : vertices)
+        {
+            numArcs += u.outDegree;
+            u.outDegree = 0;
+            u.inDegree = 0;
+            u.sourceEdges = nullptr;
+            u.destinationEdges = nullptr;
+        }
+        vertexIDtoIndex = other.vertexIDtoIndex;
+        edgeIDtoSourceID = other.edgeIDtoSourceID;
+        nextVertexID = other.nextVertexID;
+        nextEdgeID = other.nextEdgeID;
+
+        edges.reserve(numArcs);
+        std::vector<std::size_t> indices = other.indicesByID();
+        for (std::size_t ui = 0; ui < vertices.size(); ui++)
+        {
+            const EdgeInfo* e = other.vertices[ui].sourceEdges;
+            while (e && e->nextFromSource) e = e->nextFromSource;
+            for (; e; e = e->prevFromSource)
+            {
+                insertEdgeByIndices(e->id, ui, indices[e->v], e->attrID, e->undirected);
+            }
+        }
+
+        if (other.arcIndex != ArcIndex::None) setArcIndex(other.arcIndex);
+    }
+
+    /// The vertex which was at index permutation[k] in other is added k-th.  An index which does
+    /// not name a vertex of other gives a vertex without edges, and one named again is not joined
+    /// twice.  An edge is kept when both of its end points are, so that a partial permutation gives
+    /// the induced subgraph.
+    void Graph::copyPermuted(const Graph& other, const std::vector<VertexID>& permutation, bool reassignAttributes)
+    {
+        const std::size_t Absent = std::numeric_limits<std::size_t>::max();
+
+        vertexAttributes = other.vertexAttributes;
+        edgeAttributes = other.edgeAttributes;
         nextVertexID = 0;
         nextEdgeID = 0;
 
-        std::unordered_map<VertexID, VertexID> map;
-        Vertex oV, oU;
-        for (auto it = other.vertexIterator(); it.next(oV); )
+        std::size_t numArcs = 0;
+        std::vector<std::size_t> newIndices(other.vertices.size(), Absent);
+        vertices.reserve(permutation.size());
+        vertexIDtoIndex.reserve(permutation.size());
+        for (std::size_t k = 0; k < permutation.size(); k++)
         {
-            VertexID v = this->addVertex(oV.attrID);
-            map.insert(std::make_pair(oV.id, v));
+            std::size_t oi = permutation[k];
+            bool valid = (oi < other.vertices.size());
+            AttrID attr = valid ? other.vertices[oi].attrID : 0;
+            if (reassignAttributes) attr = permutation[k] + 1;
+            addVertex(attr);
+            if (valid && (newIndices[oi] == Absent))
+            {
+                newIndices[oi] = k;
+                numArcs += other.vertices[oi].outDegree;
+            }
         }
 
-        for (auto it = other.vertexIterator(); it.next(oV); )
+        edges.reserve(numArcs);
+        std::vector<std::size_t> indices = other.indicesByID();
+        for (std::size_t k = 0; k < permutation.size(); k++)
         {
-            VertexID v = map[oV.id];
+            std::size_t oi = permutation[k];
+            if ((oi >= other.vertices.size()) || (newIndices[oi] != k)) continue;
 
-            for (auto it2 = other.vertexIterator(); it2.next(oU); )
+            for (const EdgeInfo* e = other.vertices[oi].sourceEdges; e; e = e->nextFromSource)
             {
-                VertexID u = map[oU.id];
+                std::size_t nk = newIndices[indices[e->v]];
+                if (nk == Absent) continue;
 
-                Edge e, e2;
-                if (!complement)
+                /// An undirected edge is met once from each end, and is added from the lower index.
+                if (e->undirected)
                 {
-                    if (other.getEdge(u, v, e) && (!e.undirected || (u < v)))
-                    {
-                        if (e.undirected)
-                            this->addEdge(u, v, e.attrID);
-                        else
-                            this->addArc(u, v, e.attrID);
-                    }
+                    if (k <= nk) addEdgeByIndices(k, nk, e->attrID, true);
                 }
                 else
                 {
-                    if (u < v)
-                    {
-                        if (other.getEdge(u, v, e))
-                        {
-                            if (!e.undirected && !other.getEdge(v, u, e2))
-                            {
-                                this->addArc(v, u, e.attrID);
-                            }
-                        }
-                        else
-                        if (other.getEdge(v, u, e2) && !e2.undirected)
-                        {
-                            this->addArc(u, v, e2.attrID);
-                        }
-                        else
-                        {
-                            this->addEdge(u, v, 0);
-                        }
-                    }
+                    addEdgeByIndices(k, nk, e->attrID, false);
                 }
             }
         }
     }
 
-    Graph::Graph(const Graph& other, const std::vector<VertexID>& permutation, bool reassignAttributes)
+    /// For each u, the vertices after u are marked in bit sets by the arcs which join them to u.
+    /// A pair joined one way only gains the arc the other way, with the same attribute, and a pair
+    /// not joined at all gains an undirected edge.  Each absent pair is read from the complement of
+    /// the marks, a word at a time, so that the cost is that of the bit sets and the arcs in and out.
+    void Graph::copyComplement(const Graph& other)
     {
+        vertexAttributes = other.vertexAttributes;
+        edgeAttributes = other.edgeAttributes;
         nextVertexID = 0;
         nextEdgeID = 0;
 
-        std::unordered_map<VertexID, VertexID> map;
-        Vertex oV;
-        Edge e;
-        for (std::size_t index = 0; index < permutation.size(); index++)
+        std::size_t n = other.vertices.size();
+        vertices.reserve(n);
+        vertexIDtoIndex.reserve(n);
+        for (const VertexInfo& u : other.vertices)
         {
-            other.getVertexByIndex(permutation[index], oV);
-            AttrID attr = oV.attrID;
-            if (reassignAttributes) attr = permutation[index] + 1;
-            VertexID v = this->addVertex(attr);
-            map.insert(std::make_pair(oV.id, v));
+            addVertex(u.attrID);
         }
 
-        for (auto it = other.vertexIterator(); it.next(oV); )
+        std::vector<std::size_t> indices = other.indicesByID();
+        IntegerSet exiting(n), entering(n), absent(n);
+        for (std::size_t u = 0; u < n; u++)
         {
-            VertexID v = map[oV.id];
-
-            for (auto it2 = other.enteringEdgeIterator(oV.id); it2.next(e); )
+            exiting.clear();
+            entering.clear();
+            for (const EdgeInfo* e = other.vertices[u].sourceEdges; e; e = e->nextFromSource)
+            {
+                exiting.add(indices[e->v]);
+            }
+            for (const EdgeInfo* e = other.vertices[u].destinationEdges; e; e = e->nextToDestination)
             {
-                VertexID u = map[e.u];
+                entering.add(indices[e->u]);
+            }
 
-                if (!e.undirected || (u < v))
+            absent.clear();
+            absent.fillAfter(u);
+            absent.removeAll(exiting);
+            absent.removeAll(entering);
+
+            /// A mark is taken off once used, so that parallel arcs give one arc in the complement.
+            for (const EdgeInfo* e = other.vertices[u].sourceEdges; e; e = e->nextFromSource)
+            {
+                std::size_t v = indices[e->v];
+                if ((v > u) && exiting.contains(v) && !entering.contains(v))
                 {
-                    if (e.undirected)
-                        this->addEdge(u, v, e.attrID);
-                    else
-                        this->addArc(u, v, e.attrID);
+                    addEdgeByIndices(v, u, e->attrID, false);
+                    exiting.remove(v);
                 }
             }
+            for (const EdgeInfo* e = other.vertices[u].destinationEdges; e; e = e->nextToDestination)
+            {
+                std::size_t v = indices[e->u];
+                if ((v > u) && entering.contains(v) && !exiting.contains(v))
+                {
+                    addEdgeByIndices(u, v, e->attrID, false);
+                    entering.remove(v);
+                }
+            }
+
+            for (auto it = absent.iterator(); it.hasNext(); )
+            {
+                addEdgeByIndices(u, it.next(), 0, true);
+            }
         }
     }
 
+    /// The edges are released with the slabs of the arena, so nothing need be unlinked.
     Graph::~Graph()
     {
-        for (std::size_t index = vertices.size(); index > 0; index--)
-        {
-            VertexID id = vertices[index - 1].id;
-            removeVertex(id);
-        }
+    }
+
+    void Graph::EdgeArena::grow()
+    {
+        slabSize = (slabSize == 0) ? FirstSlabSize : ((2 * slabSize < MaxSlabSize) ? 2 * slabSize : MaxSlabSize);
+        slabs.emplace_back(new EdgeInfo[slabSize]);
+        used = 0;
     }
 
     /// Move constructor
@@ -130,14 +214,20 @@ namespace kn
         vertices(),
         vertexIDtoIndex(),
         edgeIDtoSourceID(),
+        edges(),
         nextVertexID(1),
         nextEdgeID(1)
     {
         vertices.swap(other.vertices);
+        edges.swap(other.edges);
         std::swap(vertexAttributes, other.vertexAttributes);
         std::swap(edgeAttributes, other.edgeAttributes);
         vertexIDtoIndex.swap(other.vertexIDtoIndex);
         edgeIDtoSourceID.swap(other.edgeIDtoSourceID);
+        std::swap(arcIndex, other.arcIndex);
+        std::swap(denseArcIndex, other.denseArcIndex);
+        std::swap(arcRows, other.arcRows);
+        arcCounts.swap(other.arcCounts);
         nextVertexID = other.nextVertexID;
         nextEdgeID = other.nextEdgeID;
         other.nextVertexID = 0;
@@ -154,12 +244,19 @@ namespace kn
             edgeAttributes = nullptr;
             vertexIDtoIndex.clear();
             edgeIDtoSourceID.clear();
+            edges.clear();
+            setArcIndex(ArcIndex::None);
 
             vertices.swap(other.vertices);
+            edges.swap(other.edges);
             std::swap(vertexAttributes, other.vertexAttributes);
             std::swap(edgeAttributes, other.edgeAttributes);
             vertexIDtoIndex.swap(other.vertexIDtoIndex);
             edgeIDtoSourceID.swap(other.edgeIDtoSourceID);
+            std::swap(arcIndex, other.arcIndex);
+            std::swap(denseArcIndex, other.denseArcIndex);
+            std::swap(arcRows, other.arcRows);
+            arcCounts.swap(other.arcCounts);
 
             nextVertexID = other.nextVertexID;
             nextEdgeID = other.nextEdgeID;
@@ -175,49 +272,17 @@ namespace kn
     {
         if (this != &other)
         {
-            vertexAttributes = nullptr;
-            edgeAttributes = nullptr;
-
-            vertices.clear();
-            vertexIDtoIndex.clear();
-            edgeIDtoSourceID.clear();
-
-            nextVertexID = 0;
-            nextEdgeID = 0;
-
-            std::unordered_map<VertexID, VertexID> map;
-            Vertex oV, oU;
-            for (auto it = other.vertexIterator(); it.next(oV); )
-            {
-                VertexID v = this->addVertex(oV.attrID);
-                map.insert(std::make_pair(oV.id, v));
-            }
-
-            for (auto it = other.vertexIterator(); it.next(oV); )
-            {
-                VertexID v = map[oV.id];
-
-                for (auto it2 = other.vertexIterator(); it2.next(oU); )
-                {
-                    VertexID u = map[oU.id];
-
-                    Edge e;
-                    if (other.getEdge(u, v, e) && (!e.undirected || (u < v)))
-                    {
-                        if (e.undirected)
-                            this->addEdge(u, v, e.attrID);
-                        else
-                            this->addArc(u, v, e.attrID);
-                    }
-                }
-            }
+            setArcIndex(ArcIndex::None);
+            clear();
+            copyFrom(other);
         }
 
         return *this;
     }
 
 
-    void Graph::deleteEdge(EdgeInfo* e)
+    /// Without unindex, the arc is left in the index; removeVertex clears the index itself.
+    void Graph::deleteEdge(EdgeInfo* e, bool unindex)
     {
         EdgeInfo* nextToDestination = e->nextToDestination;
         EdgeInfo* prevToDestination = e->prevToDestination;
@@ -253,15 +318,30 @@ namespace kn
             prevFromSource->nextFromSource = nextFromSource;
         }
         edgeIDtoSourceID.erase(e->id);
+        if (unindex) unindexArc(fromIndex, toIndex, e->u, e->v);
 
-        delete e;
+        edges.release(e);
+    }
+
+    Graph::EdgeID Graph::addEdgeByIndices(std::size_t fromIndex, std::size_t toIndex, AttrID attrID, bool undirected)
+    {
+        EdgeID id = nextEdgeID++;
+        insertEdgeByIndices(id, fromIndex, toIndex, attrID, undirected);
+        if (undirected && (fromIndex != toIndex))
+        {
+            insertEdgeByIndices(id, toIndex, fromIndex, attrID, undirected);
+        }
+        edgeIDtoSourceID.insert(std::make_pair(id, vertices[fromIndex].id));
+        return id;
     }
 
     void Graph::insertEdge(EdgeID id, VertexID sourceID, VertexID destinationID, AttrID attrID, bool undirected)
     {
-        std::size_t fromIndex = vertexIDtoIndex[sourceID];
-        std::size_t toIndex = vertexIDtoIndex[destinationID];
+        insertEdgeByIndices(id, vertexIDtoIndex[sourceID], vertexIDtoIndex[destinationID], attrID, undirected);
+    }
 
+    void Graph::insertEdgeByIndices(EdgeID id, std::size_t fromIndex, std::size_t toIndex, AttrID attrID, bool undirected)
+    {
         VertexInfo* u = &vertices[fromIndex];
         VertexInfo* v = &vertices[toIndex];
 
@@ -270,12 +350,11 @@ namespace kn
         EdgeInfo* nextFromSource = u->sourceEdges;
         EdgeInfo* prevFromSource = nextFromSource ? nextFromSource->prevFromSource : nullptr;
 
-        EdgeInfo* e = new EdgeInfo;
-        assert(e);
+        EdgeInfo* e = edges.allocate();
         e->id = id;
         e->undirected = undirected;
-        e->u = sourceID;
-        e->v = destinationID;
+        e->u = u->id;
+        e->v = v->id;
         e->attrID = attrID;
         e->nextToDestination = nextToDestination;
         e->prevToDestination = prevToDestination;
@@ -304,24 +383,181 @@ namespace kn
 
         u->outDegree++;
         v->inDegree++;
+        indexArc(fromIndex, toIndex, u->id, v->id);
+    }
+
+    void Graph::setArcIndex(ArcIndex index)
+    {
+        arcIndex = index;
+        if (index == ArcIndex::None)
+        {
+            denseArcIndex = false;
+            arcRows = IntegerSetPool();
+            std::unordered_map<Pair, std::size_t, PairHash, PairEqual>().swap(arcCounts);
+        }
+        else
+        {
+            rebuildArcIndex(vertices.size());
+        }
     }
 
-    void Graph::vertexAdjacency(VertexID id, IntegerSet& row)
+    /// The Automatic choice between rows for capacity vertices and a table of numArcs entries.  A row
+    /// costs capacity bits, and an entry of the hash table some 32 bytes.  Rows are kept until they
+    /// would be four times the size at which they are first taken.
+    bool Graph::preferDenseArcIndex(std::size_t capacity, std::size_t numArcs) const
+    {
+        std::size_t slack = denseArcIndex ? 4 : 1;
+        return capacity * capacity <= slack * std::max(256 * numArcs, (std::size_t)4096 * 4096);
+    }
+
+    /// Rebuilds the index from the edge lists, with rows for at least capacity vertices if dense.
+    void Graph::rebuildArcIndex(std::size_t capacity)
+    {
+        std::size_t numVertices = vertices.size();
+        std::size_t numArcs = 0;
+        for (const VertexInfo& v : vertices)
+        {
+            numArcs += v.outDegree;
+        }
+
+        capacity = std::max(capacity, std::max(numVertices, (std::size_t)64));
+        if (arcIndex == ArcIndex::Automatic)
+        {
+            denseArcIndex = preferDenseArcIndex(capacity, numArcs);
+        }
+        else
+        {
+            denseArcIndex = (arcIndex == ArcIndex::Dense);
+        }
+
+        if (denseArcIndex)
+        {
+            std::unordered_map<Pair, std::size_t, PairHash, PairEqual>().swap(arcCounts);
+            arcRows.reshape(capacity, capacity);
+            for (std::size_t ui = 0; ui < numVertices; ui++)
+            {
+                for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+                {
+                    arcRows[ui].add(vertexIDtoIndex.at(e->v));
+                }
+            }
+        }
+        else
+        {
+            arcRows = IntegerSetPool();
+            arcCounts.clear();
+            arcCounts.reserve(numArcs);
+            for (const VertexInfo& u : vertices)
+            {
+                for (const EdgeInfo* e = u.sourceEdges; e; e = e->nextFromSource)
+                {
+                    arcCounts[Pair(e->u, e->v)]++;
+                }
+            }
+        }
+    }
+
+    void Graph::indexArc(std::size_t fromIndex, std::size_t toIndex, VertexID sourceID, VertexID destinationID)
+    {
+        if (denseArcIndex)
+        {
+            arcRows[fromIndex].add(toIndex);
+        }
+        else
+        if (arcIndex != ArcIndex::None)
+        {
+            arcCounts[Pair(sourceID, destinationID)]++;
+
+            /// The rows are given the same room as addVertex would give them.  The distinct pairs are
+            /// no more than the arcs which rebuildArcIndex counts, and so it agrees with the choice.
+            std::size_t capacity = 2 * vertices.size();
+            if ((arcIndex == ArcIndex::Automatic) && preferDenseArcIndex(capacity, arcCounts.size()))
+            {
+                rebuildArcIndex(capacity);
+            }
+        }
+    }
+
+    /// Called once the arc is unlinked.  A parallel arc may remain, and then the row keeps its bit.
+    void Graph::unindexArc(std::size_t fromIndex, std::size_t toIndex, VertexID sourceID, VertexID destinationID)
+    {
+        if (denseArcIndex)
+        {
+            for (const EdgeInfo* e = vertices[fromIndex].sourceEdges; e; e = e->nextFromSource)
+            {
+                if (e->v == destinationID) return;
+            }
+            arcRows[fromIndex].remove(toIndex);
+        }
+        else
+        if (arcIndex != ArcIndex::None)
+        {
+            auto it = arcCounts.find(Pair(sourceID, destinationID));
+            if (--it->second == 0) arcCounts.erase(it);
+        }
+    }
+
+    void Graph::vertexAdjacency(VertexID id, IntegerSet& row) const
     {
         row.clear();
-        for (std::size_t index = 0; index < vertices.size(); index++)
+        auto it = vertexIDtoIndex.find(id);
+        if (it == vertexIDtoIndex.end()) return;
+        for (const EdgeInfo* e = vertices[it->second].sourceEdges; e; e = e->nextFromSource)
         {
-            if (hasArc(id, vertices[index].id)) row.add(index);
+            row.add(vertexIDtoIndex.at(e->v));
         }
     }
 
-    std::unique_ptr<std::vector<IntegerSet>> Graph::adjacency()
+    std::unique_ptr<IntegerSetPool> Graph::adjacency(bool hugePages, unsigned numThreads) const
     {
-        std::unique_ptr<std::vector<IntegerSet>> matrix(new std::vector<IntegerSet>(vertices.size()));
-        for (std::size_t index = 0; index < vertices.size(); index++)
+        const std::size_t MinimumArcsPerThread = 1 << 16;
+
+        std::size_t n = vertices.size();
+        std::unique_ptr<IntegerSetPool> matrix(new IntegerSetPool(n, n, hugePages));
+        IntegerSetPool& rows = *matrix;
+        std::vector<std::size_t> indices = indicesByID();
+
+        auto fillRows = [this, &rows, &indices](std::size_t first, std::size_t last)
         {
-            vertexAdjacency(vertices[index].id, (*matrix)[index]);
+            for (std::size_t ui = first; ui < last; ui++)
+            {
+                IntegerSet& row = rows[ui];
+                for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+                {
+                    row.add(indices[e->v]);
+                }
+            }
+        };
+
+        std::size_t numArcs = 0;
+        for (const VertexInfo& u : vertices)
+        {
+            numArcs += u.outDegree;
+        }
+        if (numThreads == 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+        numThreads = (unsigned)std::min<std::size_t>(numThreads, numArcs / MinimumArcsPerThread);
+        if (numThreads <= 1)
+        {
+            fillRows(0, n);
+            return matrix;
         }
+
+        /// Each thread takes a run of consecutive rows holding about the same number of arcs.
+        std::vector<std::thread> workers;
+        std::size_t first = 0;
+        std::size_t arcs = 0;
+        for (unsigned t = 1; t <= numThreads; t++)
+        {
+            std::size_t last = first;
+            std::size_t quota = numArcs * t / numThreads;
+            while ((last < n) && ((arcs < quota) || (t == numThreads)))
+            {
+                arcs += vertices[last++].outDegree;
+            }
+            workers.emplace_back(fillRows, first, last);
+            first = last;
+        }
+        for (auto& worker : workers) worker.join();
         return matrix;
     }
 
@@ -390,15 +626,15 @@ namespace kn
 
         std::size_t index = it->second;
 
-        /// 1: remove all associated edges
+        /// 1: remove all associated edges; a dense index is mended as a whole in step 4
         VertexInfo* v = &vertices[index];
         while (v->destinationEdges)
         {
-            deleteEdge(v->destinationEdges);
+            deleteEdge(v->destinationEdges, !denseArcIndex);
         }
         while (v->sourceEdges)
         {
-            deleteEdge(v->sourceEdges);
+            deleteEdge(v->sourceEdges, !denseArcIndex);
         }
 
         /// 2: update vertex ID to index mapping for indices that change
@@ -411,6 +647,21 @@ namespace kn
         /// 3: remove the vertex
         vertices.erase(vertices.begin() + index);
         vertexIDtoIndex.erase(id);
+
+        /// 4: take the column of the vertex out of every row, and move the later rows up over its own
+        if (denseArcIndex)
+        {
+            std::size_t numRows = vertices.size() + 1;
+            for (std::size_t r = 0; r < numRows; r++)
+            {
+                arcRows[r].removeShift(index);
+            }
+            for (std::size_t r = index; r + 1 < numRows; r++)
+            {
+                arcRows[r].copy(arcRows[r + 1]);
+            }
+            arcRows[numRows - 1].clear();
+        }
         return true;
     }
 
@@ -482,10 +733,19 @@ namespace kn
 
     bool Graph::hasArc(VertexID sourceID, VertexID destinationID) const
     {
-        if (validVertexID(sourceID) && validVertexID(destinationID))
+        if ((arcIndex != ArcIndex::None) && !denseArcIndex)
         {
-            const VertexInfo* u = &vertices[vertexIDtoIndex.at(sourceID)];
-            const VertexInfo* v = &vertices[vertexIDtoIndex.at(destinationID)];
+            return (arcCounts.find(Pair(sourceID, destinationID)) != arcCounts.end());
+        }
+
+        auto source = vertexIDtoIndex.find(sourceID);
+        auto destination = vertexIDtoIndex.find(destinationID);
+        if ((source != vertexIDtoIndex.end()) && (destination != vertexIDtoIndex.end()))
+        {
+            if (denseArcIndex) return arcRows[source->second].contains(destination->second);
+
+            const VertexInfo* u = &vertices[source->second];
+            const VertexInfo* v = &vertices[destination->second];
 
             if (u->outDegree <= v->inDegree)
             {
@@ -505,8 +765,11 @@ namespace kn
         return false;
     }
 
+    /// The index records arcs but not whether they are undirected, so it can only rule an edge out.
     bool Graph::hasEdge(VertexID sourceID, VertexID destinationID) const
     {
+        if ((arcIndex != ArcIndex::None) && !hasArc(sourceID, destinationID)) return false;
+
         if (validVertexID(sourceID) && validVertexID(destinationID))
         {
             const VertexInfo* u = &vertices[vertexIDtoIndex.at(sourceID)];
@@ -540,6 +803,9 @@ namespace kn
             VertexID sourceID = u->id;
             VertexID destinationID = v->id;
 
+            if (denseArcIndex && !arcRows[sourceIndex].contains(destinationIndex)) return false;
+            if ((arcIndex != ArcIndex::None) && !denseArcIndex && !hasArc(sourceID, destinationID)) return false;
+
             if (u->outDegree <= v->inDegree)
             {
                 for (const EdgeInfo* e = u->sourceEdges; e; e = e->nextFromSource)
@@ -558,4 +824,169 @@ namespace kn
         return false;
     }
 
+    std::vector<bool> Graph::hasArcs(const std::vector<Pair>& pairs) const
+    {
+        std::vector<bool> result(pairs.size(), false);
+        if (arcIndex != ArcIndex::None)
+        {
+            for (std::size_t k = 0; k < pairs.size(); k++)
+            {
+                result[k] = hasArc(pairs[k].u, pairs[k].v);
+            }
+            return result;
+        }
+
+        std::vector<std::size_t> order(pairs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&pairs](std::size_t a, std::size_t b) { return pairs[a].u < pairs[b].u; });
+
+        std::unordered_set<VertexID> targets;
+        std::size_t first = 0;
+        while (first < order.size())
+        {
+            VertexID sourceID = pairs[order[first]].u;
+            std::size_t last = first + 1;
+            while ((last < order.size()) && (pairs[order[last]].u == sourceID)) last++;
+
+            if (last - first == 1)
+            {
+                result[order[first]] = hasArc(sourceID, pairs[order[first]].v);
+            }
+            else
+            if (validVertexID(sourceID))
+            {
+                targets.clear();
+                for (const EdgeInfo* e = vertices[vertexIDtoIndex.at(sourceID)].sourceEdges; e; e = e->nextFromSource)
+                {
+                    targets.insert(e->v);
+                }
+                for (std::size_t k = first; k < last; k++)
+                {
+                    result[order[k]] = (targets.count(pairs[order[k]].v) != 0);
+                }
+            }
+            first = last;
+        }
+        return result;
+    }
+
+    std::vector<Graph::VertexID> Graph::listOfVertices() const
+    {
+        std::vector<VertexID> result;
+        result.reserve(vertices.size());
+        for (const VertexInfo& u : vertices)
+        {
+            result.push_back(u.id);
+        }
+        return result;
+    }
+
+    std::vector<Graph::Pair> Graph::listOfEdges() const
+    {
+        std::vector<Pair> result;
+        result.reserve(countEdges());
+        std::vector<std::size_t> indices = indicesByID();
+        std::vector<std::size_t> targets;
+        for (std::size_t ui = 0; ui < vertices.size(); ui++)
+        {
+            VertexID u = vertices[ui].id;
+
+            targets.clear();
+            for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+            {
+                if (e->undirected && (u <= e->v)) targets.push_back(indices[e->v]);
+            }
+            std::sort(targets.begin(), targets.end());
+            targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+            for (std::size_t vi : targets)
+            {
+                result.push_back(Pair(u, vertices[vi].id));
+            }
+        }
+        return result;
+    }
+
+    std::vector<Graph::Pair> Graph::listOfArcs() const
+    {
+        std::vector<Pair> result;
+        result.reserve(countEdges());
+        std::vector<std::size_t> indices = indicesByID();
+        std::vector<std::size_t> targets;
+        for (std::size_t ui = 0; ui < vertices.size(); ui++)
+        {
+            VertexID u = vertices[ui].id;
+
+            targets.clear();
+            for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+            {
+                targets.push_back(indices[e->v]);
+            }
+            std::sort(targets.begin(), targets.end());
+            targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+            for (std::size_t vi : targets)
+            {
+                result.push_back(Pair(u, vertices[vi].id));
+            }
+        }
+        return result;
+    }
+
+    std::vector<Graph::Pair> Graph::listOfAbsentEdges() const
+    {
+        std::vector<Pair> result;
+        std::vector<std::size_t> indices = indicesByID();
+        IntegerSet neighbours(vertices.size());
+        for (std::size_t ui = 0; ui < vertices.size(); ui++)
+        {
+            VertexID u = vertices[ui].id;
+
+            neighbours.clear();
+            for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+            {
+                neighbours.add(indices[e->v]);
+            }
+            for (const EdgeInfo* e = vertices[ui].destinationEdges; e; e = e->nextToDestination)
+            {
+                neighbours.add(indices[e->u]);
+            }
+            for (std::size_t vi = 0; vi < vertices.size(); vi++)
+            {
+                VertexID v = vertices[vi].id;
+
+                if ((u < v) && !neighbours.contains(vi))
+                {
+                    result.push_back(Pair(u, v));
+                }
+            }
+        }
+        return result;
+    }
+
+    std::vector<Graph::Pair> Graph::listOfAbsentArcs() const
+    {
+        std::vector<Pair> result;
+        std::vector<std::size_t> indices = indicesByID();
+        IntegerSet neighbours(vertices.size());
+        for (std::size_t ui = 0; ui < vertices.size(); ui++)
+        {
+            VertexID u = vertices[ui].id;
+
+            neighbours.clear();
+            for (const EdgeInfo* e = vertices[ui].sourceEdges; e; e = e->nextFromSource)
+            {
+                neighbours.add(indices[e->v]);
+            }
+            for (std::size_t vi = 0; vi < vertices.size(); vi++)
+            {
+                VertexID v = vertices[vi].id;
+
+                if ((u != v) && !neighbours.contains(vi))
+                {
+                    result.push_back(Pair(u, v));
+                }
+            }
+        }
+        return result;
+    }
+
 }
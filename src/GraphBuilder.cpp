@@ -0,0 +1,193 @@
+
+#include <thread>
+#include <utility>
+#include <GraphBuilder.hpp>
+
+namespace kn
+{
+
+    namespace
+    {
+        /// Sorts values by less.  Large inputs are cut into one run per thread, the runs are sorted
+        /// concurrently, and then merged in pairs, again concurrently, until one run remains.
+        template <typename T, typename Less>
+        void parallelSort(std::vector<T>& values, Less less)
+        {
+            const std::size_t MinimumRun = 1 << 16;
+            std::size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+            numThreads = std::min(numThreads, values.size() / MinimumRun);
+            if (numThreads <= 1)
+            {
+                std::sort(values.begin(), values.end(), less);
+                return;
+            }
+
+            std::vector<std::size_t> bounds;
+            for (std::size_t t = 0; t <= numThreads; t++)
+            {
+                bounds.push_back(values.size() * t / numThreads);
+            }
+
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < numThreads; t++)
+            {
+                std::size_t first = bounds[t];
+                std::size_t last = bounds[t + 1];
+                workers.emplace_back([&values, first, last, less]()
+                {
+                    std::sort(values.begin() + first, values.begin() + last, less);
+                });
+            }
+            for (auto& worker : workers) worker.join();
+
+            while (bounds.size() > 2)
+            {
+                std::vector<std::size_t> next;
+                workers.clear();
+                std::size_t k = 0;
+                for (; k + 2 < bounds.size(); k += 2)
+                {
+                    std::size_t first = bounds[k];
+                    std::size_t middle = bounds[k + 1];
+                    std::size_t last = bounds[k + 2];
+                    workers.emplace_back([&values, first, middle, last, less]()
+                    {
+                        std::inplace_merge(values.begin() + first, values.begin() + middle, values.begin() + last, less);
+                    });
+                    next.push_back(first);
+                }
+                if (k + 1 < bounds.size()) next.push_back(bounds[k]); /// an odd run is carried over
+                next.push_back(bounds.back());
+                for (auto& worker : workers) worker.join();
+                bounds.swap(next);
+            }
+        }
+    }
+
+    void GraphBuilder::mergeEdges()
+    {
+        std::size_t n = vertexAttributes.size();
+        auto absent = [n](const Entry& e) { return (e.u >= n) || (e.v >= n); };
+        edges.erase(std::remove_if(edges.begin(), edges.end(), absent), edges.end());
+        arcs.erase(std::remove_if(arcs.begin(), arcs.end(), absent), arcs.end());
+
+        parallelSort(edges, [](const Entry& a, const Entry& b)
+        {
+            if (a.u != b.u) return a.u < b.u;
+            if (a.v != b.v) return a.v < b.v;
+            return a.order < b.order;
+        });
+        edges.erase(std::unique(edges.begin(), edges.end(), [](const Entry& a, const Entry& b)
+        {
+            return (a.u == b.u) && (a.v == b.v);
+        }), edges.end());
+    }
+
+    void GraphBuilder::insertInto(Graph& g)
+    {
+        std::size_t firstIndex = g.vertices.size();
+        std::size_t numVertices = vertexAttributes.size();
+        std::size_t numArcs = arcs.size();
+        for (const Entry& e : edges)
+        {
+            numArcs += (e.u == e.v) ? 1 : 2;
+        }
+
+        g.vertices.reserve(firstIndex + numVertices);
+        g.vertexIDtoIndex.reserve(firstIndex + numVertices);
+        g.edgeIDtoSourceID.reserve(g.edgeIDtoSourceID.size() + edges.size() + arcs.size());
+        g.edges.reserve(numArcs);
+
+        for (AttrID attrID : vertexAttributes)
+        {
+            g.addVertex(attrID);
+        }
+
+        for (const Entry& e : edges)
+        {
+            Graph::EdgeID id = g.nextEdgeID++;
+            g.insertEdgeByIndices(id, firstIndex + e.u, firstIndex + e.v, e.attrID, true);
+            if (e.u != e.v)
+            {
+                g.insertEdgeByIndices(id, firstIndex + e.v, firstIndex + e.u, e.attrID, true);
+            }
+            g.edgeIDtoSourceID.insert(std::make_pair(id, g.vertices[firstIndex + e.u].id));
+        }
+
+        for (const Entry& e : arcs)
+        {
+            Graph::EdgeID id = g.nextEdgeID++;
+            g.insertEdgeByIndices(id, firstIndex + e.u, firstIndex + e.v, e.attrID, false);
+            g.edgeIDtoSourceID.insert(std::make_pair(id, g.vertices[firstIndex + e.u].id));
+        }
+    }
+
+    void GraphBuilder::build(Graph& g)
+    {
+        mergeEdges();
+        insertInto(g);
+        clear();
+    }
+
+    CsrGraph GraphBuilder::buildFrozen(Graph& g)
+    {
+        if (g.countVertices() != 0)
+        {
+            build(g);
+            return CsrGraph(g);
+        }
+
+        mergeEdges();
+
+        std::size_t numVertices = vertexAttributes.size();
+        std::vector<std::size_t> outOffsets(numVertices + 1, 0);
+        for (const Entry& e : edges)
+        {
+            outOffsets[e.u + 1]++;
+            if (e.u != e.v) outOffsets[e.v + 1]++;
+        }
+        for (const Entry& e : arcs)
+        {
+            outOffsets[e.u + 1]++;
+        }
+        for (std::size_t u = 0; u < numVertices; u++)
+        {
+            outOffsets[u + 1] += outOffsets[u];
+        }
+
+        /// The edges are sorted by (u, v) with u <= v.  The list of x thus receives its arcs back to
+        /// each u < x first, in increasing order of u, and then its arcs out to each v >= x, in order.
+        /// Only arcs, which come in any order, oblige the lists to be sorted afterwards.
+        std::vector<std::pair<uint32_t, AttrID>> lists(outOffsets[numVertices]);
+        std::vector<std::size_t> fill(outOffsets.begin(), outOffsets.end() - 1);
+        for (const Entry& e : edges)
+        {
+            lists[fill[e.u]++] = std::make_pair((uint32_t)e.v, e.attrID);
+            if (e.u != e.v) lists[fill[e.v]++] = std::make_pair((uint32_t)e.u, e.attrID);
+        }
+        for (const Entry& e : arcs)
+        {
+            lists[fill[e.u]++] = std::make_pair((uint32_t)e.v, e.attrID);
+        }
+        if (!arcs.empty())
+        {
+            for (std::size_t u = 0; u < numVertices; u++)
+            {
+                std::sort(lists.begin() + outOffsets[u], lists.begin() + outOffsets[u + 1]);
+            }
+        }
+
+        std::vector<uint32_t> outTargets(lists.size());
+        std::vector<AttrID> outAttributes(lists.size());
+        for (std::size_t t = 0; t < lists.size(); t++)
+        {
+            outTargets[t] = lists[t].first;
+            outAttributes[t] = lists[t].second;
+        }
+
+        insertInto(g);
+        clear();
+        return CsrGraph(g, std::move(outOffsets), std::move(outTargets), std::move(outAttributes));
+    }
+
+}
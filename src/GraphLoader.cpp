@@ -1,5 +1,6 @@
 
 #include <GraphLoader.hpp>
+#include <GraphBuilder.hpp>
 #include <algorithm>
 #include <istream>
 #include <iomanip>
@@ -17,6 +18,7 @@ namespace kn
     {
         g.clear();
 
+        GraphBuilder builder;
         std::string line;
         std::size_t numVertices = 0;
         std::size_t row = 0;
@@ -31,25 +33,23 @@ namespace kn
                 none = false;
                 if (column == numVertices)
                 {
-                    g.addVertex(0);
+                    builder.addVertex(0);
                     numVertices++;
                 }
                 int value = std::stoi(entry);
                 if (value != 0)
                 {
                     if (directed)
-                        g.addArc(row, column, 0);
+                        builder.addArc(row, column, 0);
                     else
-                    if (!g.hasEdge(row, column))
-                    {
-                        g.addEdge(row, column, 0);
-                    }
+                        builder.addEdge(row, column, 0);
                 }
                 column++;
             }
             if (none) break;
             row++;
         }
+        builder.build(g);
     }
 
     Graph* GraphLoader::loadAdjacencyMatrix(char delim, bool directed)
@@ -61,8 +61,8 @@ namespace kn
 
     void GraphLoader::loadAdjacencyList(Graph& g, char delim, bool directed)
     {
+        GraphBuilder builder;
         std::string line;
-        std::size_t numVertices = 0;
         while (std::getline(stream, line))
         {
             std::stringstream lstream(line);
@@ -70,31 +70,21 @@ namespace kn
             if (std::getline(lstream, entry, delim))
             {
                 std::size_t source = (std::size_t) std::stoi(entry) - 1;
-                while (source >= numVertices)
-                {
-                    g.addVertex(0);
-                    numVertices++;
-                }
+                builder.ensureVertex(source);
                 while (std::getline(lstream, entry, delim))
                 {
                     std::size_t dest = (std::size_t) std::stoi(entry) - 1;
-                    while (dest >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
+                    builder.ensureVertex(dest);
                     if (directed)
-                        g.addArc(source, dest, 0);
+                        builder.addArc(source, dest, 0);
                     else
-                    if (!g.hasEdge(source, dest))
-                    {
-                        g.addEdge(source, dest, 0);
-                    }
+                        builder.addEdge(source, dest, 0);
                 }
             }
             else
                 break;
         }
+        builder.build(g);
     }
 
     Graph* GraphLoader::loadAdjacencyList(char delim, bool directed)
@@ -106,8 +96,8 @@ namespace kn
 
     void GraphLoader::loadDIMACS(Graph& g)
     {
+        GraphBuilder builder;
         std::string line;
-        std::size_t numVertices = 0;
         while (std::getline(stream, line))
         {
             std::stringstream lstream(line);
@@ -124,25 +114,14 @@ namespace kn
                     lstream >> dest;
                     source--;
                     dest--;
-                    while (source >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    while (dest >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    if (!g.hasEdge(source, dest))
-                    {
-                        g.addEdge(source, dest, 0);
-                    }
+                    builder.ensureVertex(std::max(source, dest));
+                    builder.addEdge(source, dest, 0);
                 }
             }
             else
                 break;
         }
+        builder.build(g);
     }
 
     Graph* GraphLoader::loadDIMACS()
@@ -164,6 +143,7 @@ namespace kn
         stream.seekg(preambleSize, std::ios_base::cur);
 
         // read data
+        GraphBuilder builder;
         std::vector<unsigned char> row;
         row.reserve(256);
         std::size_t i = 0;
@@ -177,7 +157,7 @@ namespace kn
             if (!stream) break;
 
             // we now have data for another vertex
-            g.addVertex(0);
+            builder.addVertex(0);
 
             for (std::size_t j = 0; j <= i; j++)
             {
@@ -186,10 +166,11 @@ namespace kn
 
                 if ((row[index] & bit) == bit)
                 {
-                    g.addEdge(i, j, 0);
+                    builder.addEdge(i, j, 0);
                 }
             }
         }
+        builder.build(g);
 
         // note: the originally published loader would fail if the graph size was not present in the preamble
     }
@@ -203,8 +184,8 @@ namespace kn
 
     void GraphLoader::loadAttributedDIMACS(Graph& g)
     {
+        GraphBuilder builder;
         std::string line;
-        std::size_t numVertices = 0;
         while (std::getline(stream, line))
         {
             std::stringstream lstream(line);
@@ -220,8 +201,7 @@ namespace kn
                     lstream >> attr;
                     if (!lstream) attr = 0;
 
-                    g.addVertex(attr);
-                    numVertices++;
+                    builder.addVertex(attr);
                 }
                 else
                 if (key == "e")
@@ -234,25 +214,14 @@ namespace kn
                     if (!lstream) attr = 0;
                     source--;
                     dest--;
-                    while (source >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    while (dest >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    if (!g.hasEdge(source, dest))
-                    {
-                        g.addEdge(source, dest, attr);
-                    }
+                    builder.ensureVertex(std::max(source, dest));
+                    builder.addEdge(source, dest, attr);
                 }
             }
             else
                 break;
         }
+        builder.build(g);
     }
 
     Graph* GraphLoader::loadAttributedDIMACS()
@@ -264,7 +233,7 @@ namespace kn
 
     void GraphLoader::loadLinearDIMACS(Graph& g, const std::string dimacs)
     {
-        std::size_t numVertices = 0;
+        GraphBuilder builder;
         std::stringstream lstream(dimacs);
 
         std::string key = "";
@@ -281,8 +250,7 @@ namespace kn
                     lstream >> attr;
                     if (!lstream) attr = 0;
 
-                    g.addVertex(attr);
-                    numVertices++;
+                    builder.addVertex(attr);
                 }
                 else
                 if (key == "e")
@@ -295,25 +263,14 @@ namespace kn
                     if (std::isdigit(lstream.peek())) lstream >> attr;
                     source--;
                     dest--;
-                    while (source >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    while (dest >= numVertices)
-                    {
-                        g.addVertex(0);
-                        numVertices++;
-                    }
-                    if (!g.hasEdge(source, dest))
-                    {
-                        g.addEdge(source, dest, attr);
-                    }
+                    builder.ensureVertex(std::max(source, dest));
+                    builder.addEdge(source, dest, attr);
                 }
                 else
                     break;
             }
         }
+        builder.build(g);
     }
 
     Graph* GraphLoader::loadLinearDIMACS(const std::string dimacs)
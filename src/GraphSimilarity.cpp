@@ -4,7 +4,7 @@
 namespace kn
 {
 
-    void FixedPointSimilarity::doInit(Matrix<float>& newSim, const Graph& a, const Graph& b)
+    void FixedPointSimilarity::doInit(Matrix<float>& newSim, const CsrGraph& a, const CsrGraph& b)
     {
         std::size_t rows = a.countVertices();
         std::size_t columns = b.countVertices();
@@ -18,7 +18,7 @@ namespace kn
         }
     }
 
-    bool FixedPointSimilarity::doPostprocess(const Graph& a, const Graph& b, Matrix<float>& newSim, const Matrix<float>& sim)
+    bool FixedPointSimilarity::doPostprocess(const CsrGraph& a, const CsrGraph& b, Matrix<float>& newSim, const Matrix<float>& sim)
     {
         std::size_t rows = a.countVertices();
         std::size_t columns = b.countVertices();
@@ -29,16 +29,15 @@ namespace kn
         {
             for (std::size_t column = 0; column < columns; column++)
             {
-                Graph::Vertex va, vb;
-                a.getVertexByIndex(row, va);
-                b.getVertexByIndex(column, vb);
+                Graph::AttrID va = a.getVertexAttribute(row);
+                Graph::AttrID vb = b.getVertexAttribute(column);
                 float value = sim.getValue(row, column);
-                if ((am == nullptr) && (va.attrID == vb.attrID))
+                if ((am == nullptr) && (va == vb))
                 {
                     newSim.setValue(row, column, (1.0f + value) / 3.0f);
                 }
                 else
-                if ((am != nullptr) && (am->compatible(va.attrID, vb.attrID)))
+                if ((am != nullptr) && (am->compatible(va, vb)))
                 {
                     newSim.setValue(row, column, (1.0f + value) / 3.0f);
                 }
@@ -52,6 +51,11 @@ namespace kn
     }
 
     void FixedPointSimilarity::solve(Matching<float>& mapping, const Graph& a, const Graph& b, double threshold)
+    {
+        solve(mapping, a.freeze(), b.freeze(), threshold);
+    }
+
+    void FixedPointSimilarity::solve(Matching<float>& mapping, const CsrGraph& a, const CsrGraph& b, double threshold)
     {
         index = 0;
         concludedIndex = 0;
@@ -71,7 +75,7 @@ namespace kn
         assignmentSolver->maximise(mapping, sim[index]);
     }
 
-    void BlondelSimilarity::doInit(Matrix<float>& newSim, const Graph& a, const Graph& b)
+    void BlondelSimilarity::doInit(Matrix<float>& newSim, const CsrGraph& a, const CsrGraph& b)
     {
         Matrix<float> A, B, M2, s;
 
@@ -1,5 +1,6 @@
 
 #include <Graph_ErdosRenyi.hpp>
+#include <GraphBuilder.hpp>
 
 namespace kn
 {
@@ -9,10 +10,11 @@ namespace kn
         {
             uint32_t numVertAttributes = vertexAttributes ? (uint32_t)vertexAttributes->count() : 0;
             uint32_t numEdgeAttributes = edgeAttributes ? (uint32_t)edgeAttributes->count() : 0;
-            Graph* g = new Graph(vertexAttributes, edgeAttributes);
+            GraphBuilder builder;
+            builder.reserve(n, (std::size_t)(p * n * (n - 1.0) / 2.0));
             for (uint32_t v = 0; v < n; v++)
             {
-                g->addVertex(r.nextUInt(numVertAttributes));
+                builder.addVertex(r.nextUInt(numVertAttributes));
             }
 
             for (uint32_t v = 0; v < n; v++)
@@ -21,12 +23,12 @@ namespace kn
                 {
                     if (r.nextDoubleCO() < p)
                     {
-                        g->addEdge(u, v, r.nextUInt(numEdgeAttributes));
+                        builder.addEdge(u, v, r.nextUInt(numEdgeAttributes));
                     }
                 }
             }
 
-            return g;
+            return builder.build(vertexAttributes, edgeAttributes);
         }
 
         void shuffleN(Random& r, std::vector<Graph::Pair>& vec, std::size_t n)
@@ -49,22 +51,32 @@ namespace kn
         {
             uint32_t numVertAttributes = vertexAttributes? (uint32_t)vertexAttributes->count() : 0;
             uint32_t numEdgeAttributes = edgeAttributes ? (uint32_t)edgeAttributes->count() : 0;
-            Graph* g = new Graph(vertexAttributes, edgeAttributes);
+            GraphBuilder builder;
+            builder.reserve(n, m);
             for (uint32_t v = 0; v < n; v++)
             {
-                g->addVertex(r.nextUInt(numVertAttributes));
+                builder.addVertex(r.nextUInt(numVertAttributes));
             }
 
-            std::vector<Graph::Pair> availableEdges = g->listOfAbsentEdges();
+            /// Every pair is absent from a graph without edges; these are listed as listOfAbsentEdges would.
+            std::vector<Graph::Pair> availableEdges;
+            availableEdges.reserve((std::size_t)n * (n - 1) / 2);
+            for (uint32_t u = 0; u < n; u++)
+            {
+                for (uint32_t v = u + 1; v < n; v++)
+                {
+                    availableEdges.push_back(Graph::Pair(u, v));
+                }
+            }
             shuffleN(r, availableEdges, m);
 
             for (std::size_t p = 0; p < m; p++)
             {
                 Graph::Pair pair = availableEdges[p];
-                g->addEdge(pair.u, pair.v, r.nextUInt(numEdgeAttributes));
+                builder.addEdge(pair.u, pair.v, r.nextUInt(numEdgeAttributes));
             }
 
-            return g;
+            return builder.build(vertexAttributes, edgeAttributes);
         }
 
     }